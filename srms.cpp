@@ -5,34 +5,91 @@
 #include <string>
 #include <sstream>
 #include <algorithm>
+#include <unordered_map>
+#include <unordered_set>
+#include <cstdio>
+#include <filesystem>
+#include <string_view>
+#include <charconv>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <mutex>
+#include <shared_mutex>
+#include <condition_variable>
+#include <functional>
+#include <deque>
+#include <atomic>
+#include <random>
+#include <set>
+#include <map>
+#include <numeric>
+#include <climits>
+#include <memory>
+#include <csignal>
+#include <cmath>
+#include <iomanip>
+#include <ctime>
+#include <future>
+#include <list>
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SRMS_AVX2 1
+#include <immintrin.h>
+#endif
+#include <fcntl.h>
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+#ifdef __linux__
+#define SRMS_SERVER 1
+#include <sys/socket.h>
+#include <sys/epoll.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <cerrno>
+#endif
 using namespace std;
 
 /*
   SRMS - Single-file final program
-  - Subjects: Maths, Physics, Chemistry, English, Computer
+  - Subjects: set per data directory (srms --set-subjects), Maths, Physics, Chemistry, English, Computer by default
   - Files used:
-    students.txt       (roll|name|parentName|parentMobile|m1,m2,m3,m4,m5|complaint)
-    student_login.txt  (roll|password)
-    parent_login.txt   (roll|password)
-    admin_login.txt    (username password)
-    complaints.txt     (roll|complaint)
+    students.txt       (#subjects|A,B,... then roll|name|parentName|parentMobile|m1,m2,...|  last field: complaint, old format only)
+    student_login.txt  (roll|passwordHash, appended; last line wins, empty = removed)
+    parent_login.txt   (roll|passwordHash, same rules)
+    admin_login.txt    (username passwordHash; plaintext from older versions is hashed on load)
+    complaints.log     (complaint tickets: O|id|roll|priority|openedAt|text or R|id|resolvedAt, appended)
+    students.journal   (P|<students.txt line> or D|roll, replayed over students.txt)
+    students.bin       (optional binary snapshot, used instead of students.txt when present)
+    students.d/        (optional roll-range shards, used instead of both when present)
+    marks.history      (marks of every closed term, bit-packed columns, appended)
+    results.draft      (roll|subject|mark staged for the next publish, appended; results.publish while publishing)
 */
 
-const vector<string> SUBJECTS = {"Maths", "Physics", "Chemistry", "English", "Computer"};
-const int NUM_SUBJECTS = 5;
+// the subjects of a roster whose files do not name their own (see Subject schema)
+const vector<string> DEFAULT_SUBJECTS = {"Maths", "Physics", "Chemistry", "English", "Computer"};
+// marks are kept inline in a Student, so a schema has at most this many subjects
+const int MAX_SUBJECTS = 16;
+// the active schema; the loaders set it from the roster file headers
+vector<string> subjectNames = DEFAULT_SUBJECTS;
+int numSubjects = (int)DEFAULT_SUBJECTS.size();
 
+// one student as a plain value: what parsers produce and what the UI, batch mode and
+// the server get back. The store keeps a compact StudentRecord instead.
 struct Student {
     int roll = 0;
     string name;
     string parentName;
     string parentMobile;
-    float marks[NUM_SUBJECTS];
-    string complaint;
+    float marks[MAX_SUBJECTS];
 };
 
-// in-memory students
-vector<Student> students;
-
 // -------------------- Helpers --------------------
 vector<string> split(const string &s, char delim) {
     vector<string> parts;
@@ -54,6 +111,12 @@ string trim(const string &s) {
     return s.substr(a, b - a + 1);
 }
 
+void appendFloat(string &out, float v) {
+    char buf[32];
+    auto r = to_chars(buf, buf + sizeof(buf), v);
+    out.append(buf, r.ptr);
+}
+
 bool isDigits(const string &s) {
     if (s.empty()) return false;
     for (char c : s) if (!isdigit((unsigned char)c)) return false;
@@ -66,6 +129,58 @@ bool isAlphaOrSpace(const string &s) {
     return true;
 }
 
+string_view trimView(string_view s) {
+    size_t a = s.find_first_not_of(" \t\r\n");
+    if (a == string_view::npos) return {};
+    size_t b = s.find_last_not_of(" \t\r\n");
+    return s.substr(a, b - a + 1);
+}
+
+bool isDigitsView(string_view s) {
+    if (s.empty()) return false;
+    for (char c : s) if (!isdigit((unsigned char)c)) return false;
+    return true;
+}
+
+// like stof on an already trimmed field: leading '+' allowed, trailing junk ignored
+bool parseFloatView(string_view s, float &out) {
+    if (!s.empty() && s[0] == '+') s.remove_prefix(1);
+    auto r = from_chars(s.data(), s.data() + s.size(), out);
+    return r.ec == errc();
+}
+
+// standard alphabet, padding optional; false on any other character
+bool base64Decode(string_view in, string &out) {
+    out.clear();
+    unsigned buf = 0; int bits = 0;
+    for (char c : in) {
+        int v;
+        if (c >= 'A' && c <= 'Z') v = c - 'A';
+        else if (c >= 'a' && c <= 'z') v = c - 'a' + 26;
+        else if (c >= '0' && c <= '9') v = c - '0' + 52;
+        else if (c == '+') v = 62;
+        else if (c == '/') v = 63;
+        else if (c == '=') break;
+        else return false;
+        buf = (buf << 6) | (unsigned)v; bits += 6;
+        if (bits >= 8) { bits -= 8; out.push_back((char)((buf >> bits) & 0xff)); }
+    }
+    return true;
+}
+
+string base64Encode(string_view in) {
+    static const char *tbl = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    string out;
+    unsigned buf = 0; int bits = 0;
+    for (unsigned char c : in) {
+        buf = (buf << 8) | c; bits += 8;
+        while (bits >= 6) { bits -= 6; out.push_back(tbl[(buf >> bits) & 63]); }
+    }
+    if (bits > 0) out.push_back(tbl[(buf << (6 - bits)) & 63]);
+    while (out.size() % 4) out.push_back('=');
+    return out;
+}
+
 string removeSpaces(const string &s) {
     string out;
     for (char c : s) if (c != ' ') out.push_back(c);
@@ -79,446 +194,4406 @@ string pad3(int x) {
     return to_string(last3);
 }
 
+// the old derivation from name and roll; guessable, so only synthetic rosters
+// (--generate) and the tools that replay them still use it
 string generatePassword(const string &name, int roll, char type) {
     string cleaned = removeSpaces(name);
     string special = (type == 'S') ? "@" : "#";
     return cleaned + special + pad3(roll);
 }
 
+// first password of a new account: the name and 6 random characters
+string initialPassword(const string &name, char type) {
+    static const char alphabet[] = "abcdefghjkmnpqrstuvwxyzABCDEFGHJKLMNPQRSTUVWXYZ23456789";
+    thread_local random_device rd;
+    uniform_int_distribution<int> pick(0, (int)sizeof alphabet - 2);
+    string out = removeSpaces(name) + (type == 'S' ? "@" : "#");
+    for (int i = 0; i < 6; ++i) out += alphabet[pick(rd)];
+    return out;
+}
+
 // safe stoi and stof with checks used where needed
 
-// -------------------- File IO --------------------
-void saveStudentsToFiles() {
-    // students.txt
-    ofstream sOut("students.txt");
-    for (auto &st : students) {
-        sOut << st.roll << "|" << st.name << "|" << st.parentName << "|" << st.parentMobile << "|";
-        // marks as comma separated
-        for (int i = 0; i < NUM_SUBJECTS; ++i) {
-            sOut << st.marks[i];
-            if (i + 1 < NUM_SUBJECTS) sOut << ",";
-        }
-        sOut << "|" << st.complaint << "\n";
-    }
-    sOut.close();
+// -------------------- Subject schema --------------------
+/*
+  Each deployment names its own subjects (srms --set-subjects), and the roster files
+  store them in their header, so a data directory carries its own schema. Files
+  written before that get DEFAULT_SUBJECTS.
+  Loops over one student's marks are templates on the subject count. Each common count
+  gets its own instantiation with a fixed trip count that the compiler unrolls.
+  ANY_SUBJECTS is the runtime loop for every other count. withSubjectCount() picks
+  the instantiation, once per call or once around a loop over the whole roster.
+*/
+const int ANY_SUBJECTS = 0;
+const size_t MAX_SUBJECT_NAME = 32;
 
-    // complaints.txt (rebuild from students complaint field)
-    ofstream cOut("complaints.txt");
-    for (auto &st : students) {
-        if (!trim(st.complaint).empty()) {
-            cOut << st.roll << "|" << st.complaint << "\n";
-        }
+template <int N>
+inline int subjectCount() { return N == ANY_SUBJECTS ? numSubjects : N; }
+
+// fn(integral_constant<int, N>): N is numSubjects for 5-9 subjects, ANY_SUBJECTS otherwise
+template <typename Fn>
+decltype(auto) withSubjectCount(Fn &&fn) {
+    switch (numSubjects) {
+    case 5: return fn(integral_constant<int, 5>());
+    case 6: return fn(integral_constant<int, 6>());
+    case 7: return fn(integral_constant<int, 7>());
+    case 8: return fn(integral_constant<int, 8>());
+    case 9: return fn(integral_constant<int, 9>());
+    default: return fn(integral_constant<int, ANY_SUBJECTS>());
     }
-    cOut.close();
 }
 
-void loadStudentsFromFiles() {
-    students.clear();
-    ifstream sIn("students.txt");
-    if (!sIn) return; // no file yet
-    string line;
-    while (getline(sIn, line)) {
-        line = trim(line);
-        if (line.empty()) continue;
-        vector<string> parts = split(line, '|');
-        if (parts.size() != 6) continue; // malformed
-        string rollStr = trim(parts[0]);
-        if (!isDigits(rollStr)) continue;
-        Student st;
-        st.roll = stoi(rollStr);
-        st.name = trim(parts[1]);
-        st.parentName = trim(parts[2]);
-        st.parentMobile = trim(parts[3]);
-        // parse marks
-        vector<string> mparts = split(parts[4], ',');
-        if (mparts.size() != NUM_SUBJECTS) {
-            // if missing, set to 0
-            for (int i = 0; i < NUM_SUBJECTS; ++i) st.marks[i] = 0;
-        } else {
-            for (int i = 0; i < NUM_SUBJECTS; ++i) {
-                string ms = trim(mparts[i]);
-                try {
-                    st.marks[i] = stof(ms);
-                } catch (...) { st.marks[i] = 0; }
-            }
-        }
-        st.complaint = parts[5];
-        students.push_back(st);
+// "m1,m2,...": false unless there is one mark per subject; an unparsable mark reads as 0
+template <int N>
+bool parseMarksN(string_view ms, float *marks) {
+    const int n = subjectCount<N>();
+    for (int i = 0; i < n; ++i) {
+        size_t comma = ms.find(',');
+        if ((comma == string_view::npos) != (i == n - 1)) return false;
+        if (!parseFloatView(trimView(ms.substr(0, comma)), marks[i])) marks[i] = 0;
+        ms.remove_prefix(i == n - 1 ? ms.size() : comma + 1);
     }
-    sIn.close();
+    return true;
 }
 
-// -------------------- Login helpers --------------------
-bool readAdminCredentials(string &userOut, string &passOut) {
-    ifstream f("admin_login.txt");
-    if (!f) return false;
-    string u, p;
-    if (!(f >> u >> p)) return false;
-    userOut = u; passOut = p;
-    return true;
+// index of the first mark outside 0-100, -1 when all are valid
+template <int N>
+int invalidMarkN(const float *marks) {
+    const int n = subjectCount<N>();
+    for (int i = 0; i < n; ++i)
+        if (!(marks[i] >= 0 && marks[i] <= 100)) return i;
+    return -1;
 }
 
-bool adminLogin() {
-    string u, p;
-    cout << "\nEnter Admin Username: ";
-    cin >> u;
-    cout << "Enter Password: ";
-    cin >> p;
-    string user, pass;
-    if (!readAdminCredentials(user, pass)) {
-        cout << "⚠ admin_login.txt missing or malformed.\n";
-        return false;
+// comma-separated, as in the roster files
+template <int N>
+void appendMarksN(string &out, const float *marks) {
+    const int n = subjectCount<N>();
+    for (int i = 0; i < n; ++i) {
+        if (i) out += ',';
+        appendFloat(out, marks[i]);
     }
-    return (u == user && p == pass);
 }
 
-bool checkLoginFileFor(const string &filename, int roll, const string &password) {
-    ifstream f(filename);
-    if (!f) return false;
-    string line;
-    while (getline(f, line)) {
-        line = trim(line);
-        if (line.empty()) continue;
-        vector<string> p = split(line, '|');
-        if (p.size() != 2) continue;
-        if (!isDigits(trim(p[0]))) continue;
-        int r = stoi(trim(p[0]));
-        string pw = trim(p[1]);
-        if (r == roll && pw == password) return true;
-    }
-    return false;
+template <int N>
+float sumMarksN(const float *marks) {
+    const int n = subjectCount<N>();
+    float t = 0;
+    for (int i = 0; i < n; ++i) t += marks[i];
+    return t;
 }
 
-bool studentLogin(int &rollOut) {
-    string rollStr, pass;
-    cout << "Enter Roll Number: ";
-    cin >> rollStr;
-    while (!isDigits(rollStr)) {
-        cout << "❌ Invalid roll! Enter numbers only: ";
-        cin >> rollStr;
-    }
-    int roll = stoi(rollStr);
-    cout << "Enter Password: ";
-    cin >> pass;
-    if (checkLoginFileFor("student_login.txt", roll, pass)) {
-        rollOut = roll; return true;
-    }
-    return false;
+bool parseMarks(string_view ms, float *marks) {
+    return withSubjectCount([&](auto n) { return parseMarksN<decltype(n)::value>(ms, marks); });
+}
+int invalidMark(const float *marks) {
+    return withSubjectCount([&](auto n) { return invalidMarkN<decltype(n)::value>(marks); });
+}
+void appendMarks(string &out, const float *marks) {
+    withSubjectCount([&](auto n) { appendMarksN<decltype(n)::value>(out, marks); });
+}
+float sumMarks(const float *marks) {
+    return withSubjectCount([&](auto n) { return sumMarksN<decltype(n)::value>(marks); });
 }
 
-bool parentLogin(int &rollOut) {
-    string rollStr, pass;
-    cout << "Enter Student Roll Number: ";
-    cin >> rollStr;
-    while (!isDigits(rollStr)) {
-        cout << "❌ Invalid roll! Enter numbers only: ";
-        cin >> rollStr;
+string joinSubjects(const vector<string> &names) {
+    string out;
+    for (size_t i = 0; i < names.size(); ++i) out += (i ? "," : "") + names[i];
+    return out;
+}
+
+// "Maths,Physics,...": empty string and the names in out if the list is a valid schema
+string parseSubjectList(string_view list, vector<string> &out) {
+    out.clear();
+    while (true) {
+        size_t comma = list.find(',');
+        out.emplace_back(trimView(list.substr(0, comma)));
+        if (comma == string_view::npos) break;
+        list.remove_prefix(comma + 1);
     }
-    int roll = stoi(rollStr);
-    cout << "Enter Parent Password: ";
-    cin >> pass;
-    if (checkLoginFileFor("parent_login.txt", roll, pass)) {
-        rollOut = roll; return true;
+    if (out.size() > (size_t)MAX_SUBJECTS) return "at most " + to_string(MAX_SUBJECTS) + " subjects";
+    for (size_t i = 0; i < out.size(); ++i) {
+        const string &name = out[i];
+        if (name.empty() || name.size() > MAX_SUBJECT_NAME) return "subject names must be 1-" + to_string(MAX_SUBJECT_NAME) + " characters";
+        for (char c : name)
+            if (!isalnum((unsigned char)c) && c != ' ' && c != '-' && c != '.') return name + ": only letters, digits, spaces, - and . allowed";
+        if (find(out.begin(), out.begin() + i, name) != out.begin() + i) return name + " is listed twice";
     }
-    return false;
+    return "";
 }
 
-// -------------------- Password change --------------------
-// For student/parent login files: format roll|password
-bool changePasswordInFile(const string &filename, int roll) {
-    ifstream f(filename);
-    if (!f) { cout << "⚠ File missing: " << filename << "\n"; return false; }
-    vector<pair<int,string>> entries;
-    string line;
-    bool found = false;
-    while (getline(f,line)) {
-        line = trim(line);
-        if (line.empty()) continue;
-        vector<string> p = split(line,'|');
-        if (p.size()!=2) continue;
-        string rstr = trim(p[0]); string pw = trim(p[1]);
-        if (!isDigits(rstr)) continue;
-        int r = stoi(rstr);
-        entries.push_back({r,pw});
+// -------------------- Worker pool --------------------
+// fixed set of threads draining one FIFO of jobs
+class WorkerPool {
+public:
+    explicit WorkerPool(unsigned threads) {
+        if (threads == 0) threads = 1;
+        for (unsigned i = 0; i < threads; ++i) workers.emplace_back([this] { run(); });
     }
-    f.close();
-
-    int oldRoll = roll;
-    string oldPass; cout << "Enter old password: "; cin >> oldPass;
-    // verify
-    bool ok = false;
-    for (auto &e : entries) if (e.first==oldRoll && e.second==oldPass) { ok = true; break; }
-    if (!ok) { cout<<"❌ Old password incorrect!\n"; return false; }
-
-    string newPass; cout << "Enter new password (min 6 chars): "; cin >> newPass;
-    while (newPass.length() < 6) { cout << "❌ Too short! Enter again: "; cin >> newPass; }
-    for (auto &e : entries) if (e.first==oldRoll) e.second = newPass;
+    ~WorkerPool() {
+        { lock_guard<mutex> lk(m); stopping = true; }
+        cv.notify_all();
+        for (auto &t : workers) t.join();
+    }
+    void submit(function<void()> job) {
+        { lock_guard<mutex> lk(m); jobs.push_back(std::move(job)); ++pending; }
+        cv.notify_one();
+    }
+    // blocks until every submitted job has finished
+    void wait() {
+        unique_lock<mutex> lk(m);
+        idle.wait(lk, [this] { return pending == 0; });
+    }
+    size_t size() const { return workers.size(); }
+private:
+    void run() {
+        while (true) {
+            function<void()> job;
+            {
+                unique_lock<mutex> lk(m);
+                cv.wait(lk, [this] { return stopping || !jobs.empty(); });
+                if (jobs.empty()) return;
+                job = std::move(jobs.front());
+                jobs.pop_front();
+            }
+            job();
+            lock_guard<mutex> lk(m);
+            if (--pending == 0) idle.notify_all();
+        }
+    }
+    vector<thread> workers;
+    deque<function<void()>> jobs;
+    mutex m;
+    condition_variable cv, idle;
+    size_t pending = 0;
+    bool stopping = false;
+};
 
-    ofstream out(filename);
-    for (auto &e : entries) out << e.first << "|" << e.second << "\n";
-    out.close();
-    cout << "✔ Password changed successfully!\n";
-    return true;
+unsigned hardwareThreads() {
+    unsigned n = thread::hardware_concurrency();
+    return n ? n : 2;
 }
 
-// Admin password change (admin_login.txt format: username password)
-bool changeAdminPassword() {
-    string user, pass;
-    if (!readAdminCredentials(user, pass)) { cout << "⚠ admin_login.txt missing or malformed.\n"; return false; }
-    string oldP; cout << "Enter old admin password: "; cin >> oldP;
-    if (oldP != pass) { cout << "❌ Old password incorrect!\n"; return false; }
-    string newP; cout << "Enter new admin password (min 6 chars): "; cin >> newP;
-    while (newP.length() < 6) { cout << "❌ Too short! Enter again: "; cin >> newP; }
-    ofstream out("admin_login.txt");
-    out << user << " " << newP << "\n";
-    out.close();
-    cout << "✔ Admin password changed successfully!\n";
-    return true;
+// runs fn(task) for tasks [0, n) on up to `threads` threads. Tasks are dealt round-robin
+// into one deque per thread; a thread works from the front of its own deque and, once
+// it runs dry, steals from the back of the others', so one large task does not leave
+// the rest idle. Deal the biggest tasks first.
+template <typename Fn>
+void parallelForStealing(size_t n, unsigned threads, Fn fn) {
+    threads = (unsigned)max<size_t>(1, min<size_t>(threads, n));
+    struct Queue { mutex m; deque<size_t> tasks; };
+    vector<Queue> queues(threads);
+    for (size_t i = 0; i < n; ++i) queues[i % threads].tasks.push_back(i);
+    auto take = [&](unsigned self, size_t &task) {
+        for (unsigned k = 0; k < threads; ++k) {
+            Queue &q = queues[(self + k) % threads];
+            lock_guard<mutex> lk(q.m);
+            if (q.tasks.empty()) continue;
+            if (k == 0) { task = q.tasks.front(); q.tasks.pop_front(); }
+            else { task = q.tasks.back(); q.tasks.pop_back(); }
+            return true;
+        }
+        return false;
+    };
+    auto work = [&](unsigned self) { size_t task; while (take(self, task)) fn(task); };
+    vector<thread> pool;
+    for (unsigned t = 1; t < threads; ++t) pool.emplace_back(work, t);
+    work(0);
+    for (auto &t : pool) t.join();
 }
 
-// -------------------- Student management --------------------
-bool rollExists(int roll) {
-    for (auto &s : students) if (s.roll == roll) return true;
-    return false;
-}
+// -------------------- Metrics --------------------
+/*
+  Counters and latency histograms per operation, plus bytes read/written per file.
+  Each thread owns a ThreadMetrics block and only ever updates its own with relaxed
+  atomics, so recording never takes a lock; reports add the blocks up.
+*/
+enum MetricOp {
+    OP_LOAD_STUDENTS, OP_LOAD_CREDENTIALS, OP_SAVE_SNAPSHOT, OP_JOURNAL_APPEND, OP_LOGIN, OP_LOOKUP,
+    OP_ADD_STUDENT, OP_DELETE_STUDENT, OP_UPDATE_MARKS, OP_COMPLAINT, OP_CHANGE_PASSWORD,
+    OP_VIEW_STUDENTS, OP_VIEW_COMPLAINTS, OP_CLASS_REPORT, OP_COMPACT, OP_IMPORT_CSV, OP_EXPORT_CSV,
+    OP_CHANGE_ADMIN_PASSWORD, OP_HTTP_REQUEST, OP_SEARCH, OP_REPORT_CARDS, OP_CLOSE_TERM, OP_HISTORY,
+    OP_STAGE_MARKS, OP_PUBLISH_RESULTS, OP_COUNT
+};
+const char *METRIC_OP_NAMES[OP_COUNT] = {
+    "load_students", "load_credentials", "save_snapshot", "journal_append", "login", "lookup",
+    "add_student", "delete_student", "update_marks", "complaint", "change_password",
+    "view_students", "view_complaints", "class_report", "compact", "import_csv", "export_csv",
+    "change_admin_password", "http_request", "search", "report_cards", "close_term", "history",
+    "stage_marks", "publish_results"
+};
+const char *METRIC_FILES[] = {"students.txt", "students.bin", "students.journal", "students.d", "complaints.log",
+                              "marks.history", "results.draft", "student_login.txt", "parent_login.txt", "admin_login.txt",
+                              "other"};
+const int METRIC_FILE_COUNT = 11;
+// bucket b holds durations below 2^b ns (b = 0..39, about 9 minutes)
+const int LATENCY_BUCKETS = 40;
 
-void appendLogin(const string &filename, int roll, const string &password) {
-    ofstream f(filename, ios::app);
-    f << roll << "|" << password << "\n";
-    f.close();
-}
+struct ThreadMetrics {
+    atomic<uint64_t> count[OP_COUNT] = {};
+    atomic<uint64_t> totalNs[OP_COUNT] = {};
+    atomic<uint64_t> buckets[OP_COUNT][LATENCY_BUCKETS] = {};
+    atomic<uint64_t> bytesRead[METRIC_FILE_COUNT] = {};
+    atomic<uint64_t> bytesWritten[METRIC_FILE_COUNT] = {};
+};
 
-void addStudent() {
-    Student st;
-    string rollStr;
-    cout << "\nEnter Roll Number (numbers only): ";
-    cin >> rollStr;
-    while (!isDigits(rollStr)) { cout << "❌ Invalid! Roll must contain numbers only. Re-enter: "; cin >> rollStr; }
-    st.roll = stoi(rollStr);
-    if (rollExists(st.roll)) { cout << "❌ Roll already exists. Aborting add.\n"; return; }
-    cin.ignore();
+// blocks are never freed, so totals survive their threads
+mutex metricsRegistryMutex;
+vector<unique_ptr<ThreadMetrics>> metricsRegistry;
 
-    cout << "Enter Student Full Name: ";
-    getline(cin, st.name);
-    while (!isAlphaOrSpace(st.name)) { cout << "❌ Only alphabets and spaces allowed. Re-enter name: "; getline(cin, st.name); }
+ThreadMetrics &threadMetrics() {
+    thread_local ThreadMetrics *mine = [] {
+        lock_guard<mutex> lk(metricsRegistryMutex);
+        metricsRegistry.push_back(make_unique<ThreadMetrics>());
+        return metricsRegistry.back().get();
+    }();
+    return *mine;
+}
 
-    cout << "Enter Parent Full Name: ";
-    getline(cin, st.parentName);
-    while (!isAlphaOrSpace(st.parentName)) { cout << "❌ Only alphabets and spaces allowed. Re-enter parent name: "; getline(cin, st.parentName); }
+inline void bump(atomic<uint64_t> &a, uint64_t v) { a.store(a.load(memory_order_relaxed) + v, memory_order_relaxed); }
 
-    cout << "Enter Parent Mobile (digits only, e.g. 10 digits): ";
-    string mob; cin >> mob;
-    while (!isDigits(mob) || mob.length() < 7 || mob.length() > 15) {
-        cout << "❌ Invalid mobile. Enter digits only (7-15 digits): "; cin >> mob;
-    }
-    st.parentMobile = mob;
+void recordLatency(MetricOp op, uint64_t ns) {
+    ThreadMetrics &m = threadMetrics();
+    int b = 0;
+    while (b < LATENCY_BUCKETS - 1 && (ns >> b) != 0) ++b;
+    bump(m.count[op], 1);
+    bump(m.totalNs[op], ns);
+    bump(m.buckets[op][b], 1);
+}
 
-    cout << "Enter marks for subjects (0-100):\n";
-    for (int i = 0; i < NUM_SUBJECTS; ++i) {
-        float m; cout << SUBJECTS[i] << ": "; cin >> m;
-        while (m < 0 || m > 100) { cout << "❌ Invalid marks! Enter again (0-100): "; cin >> m; }
-        st.marks[i] = m;
-    }
-    cin.ignore();
-    st.complaint = ""; // initially none
+int metricFileId(const string &filename) {
+    filesystem::path path(filename);
+    string name = path.filename().string();
+    if (path.parent_path().filename() == "students.d") name = "students.d"; // shard files
+    if (name.size() > 4 && name.compare(name.size() - 4, 4, ".tmp") == 0) name.resize(name.size() - 4);
+    for (int i = 0; i < METRIC_FILE_COUNT - 1; ++i) if (name == METRIC_FILES[i]) return i;
+    return METRIC_FILE_COUNT - 1;
+}
 
-    students.push_back(st);
-    saveStudentsToFiles();
+void recordRead(const string &filename, size_t bytes) { bump(threadMetrics().bytesRead[metricFileId(filename)], bytes); }
+void recordWrite(const string &filename, size_t bytes) { bump(threadMetrics().bytesWritten[metricFileId(filename)], bytes); }
 
-    string sPass = generatePassword(st.name, st.roll, 'S');
-    string pPass = generatePassword(st.parentName, st.roll, 'P');
-    appendLogin("student_login.txt", st.roll, sPass);
-    appendLogin("parent_login.txt", st.roll, pPass);
+// times the enclosing scope
+class MetricTimer {
+public:
+    explicit MetricTimer(MetricOp op) : op(op), start(chrono::steady_clock::now()) {}
+    ~MetricTimer() {
+        recordLatency(op, (uint64_t)chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start).count());
+    }
+private:
+    MetricOp op;
+    chrono::steady_clock::time_point start;
+};
 
-    cout << "\n✔ Student added successfully!\n";
-    cout << "Student Password: " << sPass << "\n";
-    cout << "Parent  Password: " << pPass << "\n";
-}
+struct MetricsSnapshot {
+    uint64_t count[OP_COUNT] = {}, totalNs[OP_COUNT] = {}, buckets[OP_COUNT][LATENCY_BUCKETS] = {};
+    uint64_t bytesRead[METRIC_FILE_COUNT] = {}, bytesWritten[METRIC_FILE_COUNT] = {};
+};
 
-void printStudentSummary(const Student &st) {
-    cout << "Roll: " << st.roll << "\n";
-    cout << "Name: " << st.name << "\n";
-    cout << "Parent: " << st.parentName << "\n";
-    cout << "Parent Mobile: " << (st.parentMobile.empty() ? "N/A" : st.parentMobile) << "\n";
-    cout << "Marks:\n";
-    for (int i = 0; i < NUM_SUBJECTS; ++i) {
-        cout << "  " << SUBJECTS[i] << " : " << st.marks[i] << "\n";
+MetricsSnapshot collectMetrics() {
+    MetricsSnapshot s;
+    lock_guard<mutex> lk(metricsRegistryMutex);
+    for (auto &m : metricsRegistry) {
+        for (int op = 0; op < OP_COUNT; ++op) {
+            s.count[op] += m->count[op].load(memory_order_relaxed);
+            s.totalNs[op] += m->totalNs[op].load(memory_order_relaxed);
+            for (int b = 0; b < LATENCY_BUCKETS; ++b) s.buckets[op][b] += m->buckets[op][b].load(memory_order_relaxed);
+        }
+        for (int f = 0; f < METRIC_FILE_COUNT; ++f) {
+            s.bytesRead[f] += m->bytesRead[f].load(memory_order_relaxed);
+            s.bytesWritten[f] += m->bytesWritten[f].load(memory_order_relaxed);
+        }
     }
-    cout << "Complaint: " << (trim(st.complaint).empty() ? "None" : st.complaint) << "\n";
+    return s;
 }
 
-void viewStudents() {
-    if (students.empty()) { cout << "No students present.\n"; return; }
-    cout << "\n---- STUDENT LIST ----\n";
-    for (auto &st : students) {
-        cout << st.roll << " | " << st.name << " | " << st.parentName << " | " << st.parentMobile << " | ";
-        cout << "Marks:";
-        for (int i=0;i<NUM_SUBJECTS;i++) { cout << (i==0? " " : ",") << st.marks[i]; }
-        cout << " | Complaint: " << (trim(st.complaint).empty() ? "None" : st.complaint) << "\n";
+// upper bound (ns) of the bucket holding quantile q
+uint64_t latencyQuantileNs(const MetricsSnapshot &s, int op, double q) {
+    uint64_t target = (uint64_t)ceil(q * s.count[op]), seen = 0;
+    for (int b = 0; b < LATENCY_BUCKETS; ++b) {
+        seen += s.buckets[op][b];
+        if (seen >= target && seen > 0) return 1ULL << b;
     }
+    return 1ULL << (LATENCY_BUCKETS - 1);
 }
 
-void deleteStudent() {
-    string sRoll; cout << "Enter roll number to delete: "; cin >> sRoll;
-    if (!isDigits(sRoll)) { cout << "❌ Invalid roll input.\n"; return; }
-    int r = stoi(sRoll);
-    for (auto it = students.begin(); it != students.end(); ++it) {
-        if (it->roll == r) {
-            students.erase(it);
-            saveStudentsToFiles();
-            // remove from student_login.txt and parent_login.txt and complaints.txt
-            auto removeFromFile = [&](const string &fname){
-                ifstream f(fname);
-                if (!f) return;
-                vector<string> lines; string L;
-                while (getline(f,L)) {
-                    if (trim(L).empty()) continue;
-                    vector<string> p = split(L,'|');
-                    if (p.size()<2) continue;
-                    if (isDigits(trim(p[0])) && stoi(trim(p[0]))==r) continue;
-                    lines.push_back(L);
-                }
-                f.close();
-                ofstream out(fname);
-                for (auto &x: lines) out<<x<<"\n";
-                out.close();
-            };
-            removeFromFile("student_login.txt");
-            removeFromFile("parent_login.txt");
-            // complaints file rebuilt by saveStudentsToFiles()
-            cout << "✔ Student deleted and related data removed.\n";
-            return;
+string prometheusMetrics() {
+    MetricsSnapshot s = collectMetrics();
+    ostringstream out;
+    out << "# HELP srms_op_duration_seconds Latency of SRMS operations.\n# TYPE srms_op_duration_seconds histogram\n";
+    for (int op = 0; op < OP_COUNT; ++op) {
+        uint64_t cum = 0;
+        for (int b = 0; b < LATENCY_BUCKETS; ++b) {
+            cum += s.buckets[op][b];
+            out << "srms_op_duration_seconds_bucket{op=\"" << METRIC_OP_NAMES[op] << "\",le=\"" << (double)(1ULL << b) / 1e9 << "\"} " << cum << "\n";
         }
+        out << "srms_op_duration_seconds_bucket{op=\"" << METRIC_OP_NAMES[op] << "\",le=\"+Inf\"} " << s.count[op] << "\n";
+        out << "srms_op_duration_seconds_sum{op=\"" << METRIC_OP_NAMES[op] << "\"} " << s.totalNs[op] / 1e9 << "\n";
+        out << "srms_op_duration_seconds_count{op=\"" << METRIC_OP_NAMES[op] << "\"} " << s.count[op] << "\n";
     }
-    cout << "❌ Student not found.\n";
+    out << "# HELP srms_file_read_bytes_total Bytes read per data file.\n# TYPE srms_file_read_bytes_total counter\n";
+    for (int f = 0; f < METRIC_FILE_COUNT; ++f) out << "srms_file_read_bytes_total{file=\"" << METRIC_FILES[f] << "\"} " << s.bytesRead[f] << "\n";
+    out << "# HELP srms_file_written_bytes_total Bytes written per data file.\n# TYPE srms_file_written_bytes_total counter\n";
+    for (int f = 0; f < METRIC_FILE_COUNT; ++f) out << "srms_file_written_bytes_total{file=\"" << METRIC_FILES[f] << "\"} " << s.bytesWritten[f] << "\n";
+    return out.str();
 }
 
-void updateMarks() {
-    string sRoll; cout << "Enter roll number: "; cin >> sRoll;
-    if (!isDigits(sRoll)) { cout << "❌ Invalid roll input.\n"; return; }
-    int r = stoi(sRoll);
-    for (auto &st : students) {
-        if (st.roll == r) {
-            cout << "Update marks options:\n1. Update all subjects\n2. Update single subject\nChoose: ";
-            int ch; cin >> ch;
-            if (ch == 1) {
-                for (int i = 0; i < NUM_SUBJECTS; ++i) {
-                    float m; cout << SUBJECTS[i] << ": "; cin >> m;
-                    while (m < 0 || m > 100) { cout << "❌ Invalid marks! Enter again (0-100): "; cin >> m; }
-                    st.marks[i] = m;
-                }
-            } else {
-                for (int i = 0; i < NUM_SUBJECTS; ++i) cout << i+1 << ". " << SUBJECTS[i] << "\n";
-                cout << "Choose subject number: "; int si; cin >> si;
-                if (si < 1 || si > NUM_SUBJECTS) { cout << "❌ Invalid choice.\n"; return; }
-                float m; cout << "Enter marks for " << SUBJECTS[si-1] << ": "; cin >> m;
-                while (m < 0 || m > 100) { cout << "❌ Invalid marks! Enter again (0-100): "; cin >> m; }
-                st.marks[si-1] = m;
-            }
-            saveStudentsToFiles();
-            cout << "✔ Marks updated.\n";
-            return;
-        }
+// -------------------- Roster storage --------------------
+/*
+  Interned strings: every distinct name is copied once into a bump arena of 64 KiB
+  blocks and referred to by a 32-bit id. Names repeat a lot in a class list, so a
+  roster needs far fewer bytes than one heap string per field. Strings are never
+  freed one by one; clear() drops the whole arena (reload).
+*/
+class StringPool {
+public:
+    uint32_t intern(string_view s) {
+        auto it = ids.find(s);
+        if (it != ids.end()) return it->second;
+        string_view stored = copyIn(s);
+        uint32_t id = (uint32_t)views.size();
+        views.push_back(stored);
+        ids.emplace(stored, id);
+        return id;
     }
-    cout << "❌ Student not found.\n";
-}
+    bool find(string_view s, uint32_t &id) const {
+        auto it = ids.find(s);
+        if (it == ids.end()) return false;
+        id = it->second;
+        return true;
+    }
+    string_view get(uint32_t id) const { return views[id]; }
+    size_t size() const { return views.size(); }
+    size_t arenaBytes() const { return arenaReserved; }
+    // hash map nodes (estimated at 48 bytes each) plus buckets and the id table
+    size_t indexBytes() const { return ids.size() * 48 + ids.bucket_count() * sizeof(void *) + views.capacity() * sizeof(string_view); }
+    void clear() { blocks.clear(); views.clear(); ids.clear(); used = capacity = arenaReserved = 0; }
+private:
+    static constexpr size_t BLOCK = 1 << 16;
+    vector<unique_ptr<char[]>> blocks;
+    size_t used = 0, capacity = 0, arenaReserved = 0;
+    vector<string_view> views;
+    unordered_map<string_view, uint32_t> ids;
 
-// -------------------- Complaints --------------------
-void viewComplaints() {
-    bool any = false;
-    cout << "\n--- Complaints ---\n";
-    for (auto &st : students) {
-        if (!trim(st.complaint).empty()) {
-            cout << st.roll << " | " << st.complaint << "\n";
-            any = true;
+    string_view copyIn(string_view s) {
+        if (blocks.empty() || s.size() > capacity - used) {
+            size_t n = max(BLOCK, s.size());
+            blocks.emplace_back(new char[n]);
+            capacity = n; used = 0; arenaReserved += n;
         }
+        char *p = blocks.back().get() + used;
+        memcpy(p, s.data(), s.size());
+        used += s.size();
+        return string_view(p, s.size());
     }
-    if (!any) cout << "✔ No complaints found.\n";
+};
+
+// parentMobile packed as (digit count << 50) | value; anything that is not 1-15 digits
+// is interned instead and flagged with MOBILE_INTERNED
+const uint64_t MOBILE_INTERNED = 1ULL << 63;
+const uint64_t MOBILE_VALUE_MASK = (1ULL << 50) - 1;
+
+bool packDigits(string_view m, uint64_t &packed) {
+    if (m.empty() || m.size() > 15 || !isDigitsView(m)) return false;
+    uint64_t v = 0;
+    for (char c : m) v = v * 10 + (uint64_t)(c - '0');
+    packed = ((uint64_t)m.size() << 50) | v;
+    return true;
 }
 
-void solveComplaint() {
-    // remove by roll from complaints (and student record)
-    bool any = false; for (auto &st : students) if (!trim(st.complaint).empty()) { any = true; break; }
-    if (!any) { cout << "✔ No complaints to solve.\n"; return; }
-    string sRoll; cout << "Enter roll number to mark complaint solved/remove: "; cin >> sRoll;
-    if (!isDigits(sRoll)) { cout << "❌ Invalid roll input.\n"; return; }
-    int r = stoi(sRoll);
-    for (auto &st : students) {
-        if (st.roll == r) {
-            if (trim(st.complaint).empty()) { cout << "❌ No complaint found for this roll.\n"; return; }
-            st.complaint = "";
-            saveStudentsToFiles();
-            cout << "✔ Complaint removed for roll " << r << ".\n";
-            return;
-        }
-    }
-    cout << "❌ Student not found.\n";
+// one student as stored (24 bytes); the marks live only in markColumns
+struct StudentRecord {
+    int32_t roll;
+    uint32_t name, parentName; // namePool ids
+    uint64_t mobile;           // see packDigits
+};
+
+// in-memory students
+vector<StudentRecord> students;
+// names, parent names and mobiles that do not pack into digits
+StringPool namePool;
+// roll -> position in students (kept in sync by insertStudent/removeStudent)
+unordered_map<int, size_t> rollIndex;
+// the marks, column per subject: markColumns[subject][position in students]; one
+// column per subject of the active schema
+vector<vector<float>> markColumns(DEFAULT_SUBJECTS.size());
+// guards students, namePool, rollIndex, markColumns, the secondary indexes and the
+// roster files: shared for reads, exclusive for writes
+shared_mutex storeMutex;
+// bumped by every change to the roster (under storeMutex), so a copy of it can tell
+// whether it is still current
+atomic<uint64_t> rosterVersion{0};
+
+// everything below expects the caller to hold storeMutex
+uint64_t packMobile(string_view m) {
+    uint64_t packed;
+    if (m.empty()) return 0;
+    return packDigits(m, packed) ? packed : MOBILE_INTERNED | namePool.intern(m);
 }
 
-// -------------------- Student / Parent actions --------------------
-void studentView(int roll) {
-    for (auto &st : students) {
-        if (st.roll == roll) {
-            cout << "\n=============================\n";
-            cout << "       🧑‍🎓 STUDENT PORTAL\n";
-            cout << "=============================\n";
-            printStudentSummary(st);
-            return;
-        }
-    }
-    cout << "❌ Student record not found.\n";
+// looks a mobile up without interning it; false if no stored mobile can match
+bool findPackedMobile(string_view m, uint64_t &packed) {
+    if (m.empty()) { packed = 0; return true; }
+    if (packDigits(m, packed)) return true;
+    uint32_t id;
+    if (!namePool.find(m, id)) return false;
+    packed = MOBILE_INTERNED | id;
+    return true;
 }
 
-void parentView(int roll) {
-    for (auto &st : students) {
-        if (st.roll == roll) {
-            cout << "\n=============================\n";
-            cout << "        PARENT VIEW\n";
-            cout << "=============================\n";
-            printStudentSummary(st);
-            return;
-        }
-    }
-    cout << "❌ Student record not found.\n";
+// buf needs 16 bytes; the view points into buf or into namePool
+string_view mobileView(uint64_t packed, char *buf) {
+    if (packed & MOBILE_INTERNED) return namePool.get((uint32_t)packed);
+    size_t len = (size_t)(packed >> 50);
+    uint64_t v = packed & MOBILE_VALUE_MASK;
+    for (size_t i = len; i-- > 0; v /= 10) buf[i] = (char)('0' + v % 10);
+    return string_view(buf, len);
 }
 
-void raiseComplaintWithConfirm(int roll) {
-    cin.ignore();
-    cout << "Enter your complaint (single line):\n";
-    string complaintText;
-    getline(cin, complaintText);
-    complaintText = trim(complaintText);
-    if (complaintText.empty()) { cout << "❌ Complaint cannot be empty.\n"; return; }
+string_view nameOf(const StudentRecord &r) { return namePool.get(r.name); }
+string_view parentNameOf(const StudentRecord &r) { return namePool.get(r.parentName); }
 
-    cout << "\nYou entered:\n\"" << complaintText << "\"\n";
-    cout << "Submit complaint? (Y/N): ";
-    char ch; cin >> ch;
-    if (ch == 'Y' || ch == 'y') {
-        for (auto &st : students) {
-            if (st.roll == roll) {
-                st.complaint = complaintText;
-                saveStudentsToFiles();
-                cout << "✔ Complaint submitted.\n";
-                return;
-            }
-        }
-        cout << "❌ Student not found.\n";
-    } else {
-        cout << "Complaint cancelled.\n";
-    }
+template <int N>
+void marksAtN(size_t pos, float *out) {
+    const int n = subjectCount<N>();
+    for (int i = 0; i < n; ++i) out[i] = markColumns[i][pos];
 }
 
-// -------------------- Main menu & flow --------------------
-void loadAll() {
-    loadStudentsFromFiles();
-    // Note: student_login.txt and parent_login.txt are handled on demand
+void marksAt(size_t pos, float *out) {
+    withSubjectCount([&](auto n) { marksAtN<decltype(n)::value>(pos, out); });
 }
 
-void mainMenu() {
-    loadAll();
-    while (true) {
-        cout << "\n============================\n";
-        cout << "     STUDENT RECORD SYSTEM\n";
+// a value copy of the student at a position
+Student studentAt(size_t pos) {
+    const StudentRecord &r = students[pos];
+    Student st;
+    char buf[16];
+    st.roll = r.roll;
+    st.name.assign(nameOf(r));
+    st.parentName.assign(parentNameOf(r));
+    st.parentMobile.assign(mobileView(r.mobile, buf));
+    marksAt(pos, st.marks);
+    return st;
+}
+
+// -------------------- Secondary indexes --------------------
+/*
+  Keyed by roll (positions move on swap-and-pop deletes):
+    nameIndex / parentNameIndex   (lower-case name, roll), sorted -> prefix search
+    mobileIndex                   packed parentMobile -> roll
+    markIndex[subject]            (mark, roll), sorted -> range search
+  Built on the first search and kept up to date by the roll index functions after
+  that, so loads and scripted runs that never search do not pay for them.
+  Callers hold storeMutex, exclusively for anything that modifies.
+*/
+set<pair<string, int>> nameIndex, parentNameIndex;
+unordered_multimap<uint64_t, int> mobileIndex;
+vector<set<pair<float, int>>> markIndex(DEFAULT_SUBJECTS.size());
+bool secondaryIndexesBuilt = false;
+
+string lowerCase(string_view s) {
+    string out(s);
+    for (char &c : out) c = (char)tolower((unsigned char)c);
+    return out;
+}
+
+void indexStudent(size_t pos) {
+    const StudentRecord &r = students[pos];
+    nameIndex.emplace(lowerCase(nameOf(r)), r.roll);
+    parentNameIndex.emplace(lowerCase(parentNameOf(r)), r.roll);
+    mobileIndex.emplace(r.mobile, r.roll);
+    for (int i = 0; i < numSubjects; ++i) markIndex[i].emplace(markColumns[i][pos], r.roll);
+}
+
+void unindexStudent(size_t pos) {
+    const StudentRecord &r = students[pos];
+    nameIndex.erase({lowerCase(nameOf(r)), r.roll});
+    parentNameIndex.erase({lowerCase(parentNameOf(r)), r.roll});
+    auto range = mobileIndex.equal_range(r.mobile);
+    for (auto it = range.first; it != range.second; ++it)
+        if (it->second == r.roll) { mobileIndex.erase(it); break; }
+    for (int i = 0; i < numSubjects; ++i) markIndex[i].erase({markColumns[i][pos], r.roll});
+}
+
+void clearSecondaryIndexes() {
+    nameIndex.clear();
+    parentNameIndex.clear();
+    mobileIndex.clear();
+    for (auto &idx : markIndex) idx.clear();
+    secondaryIndexesBuilt = false;
+}
+
+// sort once and construct each set from the sorted run (linear) instead of n inserts
+void buildSecondaryIndexes() {
+    clearSecondaryIndexes();
+    vector<pair<string, int>> names, parents;
+    names.reserve(students.size()); parents.reserve(students.size());
+    mobileIndex.reserve(students.size());
+    for (auto &r : students) {
+        names.emplace_back(lowerCase(nameOf(r)), r.roll);
+        parents.emplace_back(lowerCase(parentNameOf(r)), r.roll);
+        mobileIndex.emplace(r.mobile, r.roll);
+    }
+    sort(names.begin(), names.end());
+    sort(parents.begin(), parents.end());
+    nameIndex = set<pair<string, int>>(make_move_iterator(names.begin()), make_move_iterator(names.end()));
+    parentNameIndex = set<pair<string, int>>(make_move_iterator(parents.begin()), make_move_iterator(parents.end()));
+    vector<pair<float, int>> marks(students.size());
+    for (int i = 0; i < numSubjects; ++i) {
+        for (size_t j = 0; j < students.size(); ++j) marks[j] = {markColumns[i][j], students[j].roll};
+        sort(marks.begin(), marks.end());
+        markIndex[i] = set<pair<float, int>>(marks.begin(), marks.end());
+    }
+    secondaryIndexesBuilt = true;
+}
+
+// -------------------- Rank index --------------------
+/*
+  For every subject, and for the total, a Fenwick tree counting students per score
+  in 0.01 steps: a rank is one prefix sum and a mark change two point updates, so
+  the roster is never re-sorted. Scores closer than 0.005 share a step, and so a
+  rank. Built on the first rank query and kept up to date by the roll index
+  functions after that, like the secondary indexes.
+*/
+const int RANK_SCALE = 100;
+const size_t SUBJECT_BUCKETS = 100 * RANK_SCALE + 1;
+
+size_t totalBuckets() { return (size_t)numSubjects * 100 * RANK_SCALE + 1; }
+
+// counts per bucket [0, size); prefix(i) = students in buckets 0..i
+class Fenwick {
+public:
+    void assign(const vector<int> &counts) {
+        tree.assign(counts.size() + 1, 0);
+        for (size_t i = 1; i < tree.size(); ++i) {
+            tree[i] += counts[i - 1];
+            size_t up = i + (i & (~i + 1));
+            if (up < tree.size()) tree[up] += tree[i];
+        }
+        count = 0;
+        for (int c : counts) count += c;
+    }
+    void add(size_t i, int d) {
+        for (++i; i < tree.size(); i += i & (~i + 1)) tree[i] += d;
+        count += d;
+    }
+    int prefix(size_t i) const {
+        int sum = 0;
+        for (++i; i > 0; i -= i & (~i + 1)) sum += tree[i];
+        return sum;
+    }
+    int total() const { return count; }
+    void clear() { tree.clear(); tree.shrink_to_fit(); count = 0; }
+private:
+    vector<int> tree;
+    int count = 0;
+};
+
+vector<Fenwick> subjectRanks(DEFAULT_SUBJECTS.size());
+Fenwick totalRanks;
+bool rankIndexBuilt = false;
+
+size_t scoreBucket(float score, size_t buckets) {
+    long b = lround(score * RANK_SCALE);
+    return (size_t)max(0L, min(b, (long)buckets - 1));
+}
+
+template <int N>
+float rowTotalN(size_t pos) {
+    const int n = subjectCount<N>();
+    float t = 0;
+    for (int i = 0; i < n; ++i) t += markColumns[i][pos];
+    return t;
+}
+
+float rowTotal(size_t pos) {
+    return withSubjectCount([&](auto n) { return rowTotalN<decltype(n)::value>(pos); });
+}
+
+// d = +1 counts the student at pos, -1 uncounts it
+void rankStudent(size_t pos, int d) {
+    for (int i = 0; i < numSubjects; ++i) subjectRanks[i].add(scoreBucket(markColumns[i][pos], SUBJECT_BUCKETS), d);
+    totalRanks.add(scoreBucket(rowTotal(pos), totalBuckets()), d);
+}
+
+void clearRankIndex() {
+    for (auto &f : subjectRanks) f.clear();
+    totalRanks.clear();
+    rankIndexBuilt = false;
+}
+
+// bucket counts, then a linear Fenwick build per tree
+void buildRankIndex() {
+    vector<int> counts(SUBJECT_BUCKETS);
+    for (int i = 0; i < numSubjects; ++i) {
+        fill(counts.begin(), counts.end(), 0);
+        for (float m : markColumns[i]) ++counts[scoreBucket(m, SUBJECT_BUCKETS)];
+        subjectRanks[i].assign(counts);
+    }
+    size_t buckets = totalBuckets();
+    counts.assign(buckets, 0);
+    withSubjectCount([&](auto n) {
+        for (size_t pos = 0; pos < students.size(); ++pos) ++counts[scoreBucket(rowTotalN<decltype(n)::value>(pos), buckets)];
+    });
+    totalRanks.assign(counts);
+    rankIndexBuilt = true;
+}
+
+// rank 1 is the highest score and ties share the best rank; percentile is the share
+// of the class scoring the same or lower
+struct Rank {
+    int rank = 0, classSize = 0;
+    double percentile = 0;
+};
+
+Rank rankIn(const Fenwick &f, size_t bucket) {
+    Rank r;
+    r.classSize = f.total();
+    int atOrBelow = f.prefix(bucket);
+    r.rank = r.classSize - atOrBelow + 1;
+    r.percentile = r.classSize ? 100.0 * atOrBelow / r.classSize : 0;
+    return r;
+}
+
+// -------------------- Roll index --------------------
+// everything in this section expects the caller to hold storeMutex
+const size_t NO_POS = SIZE_MAX;
+
+size_t findPos(int roll) {
+    auto it = rollIndex.find(roll);
+    return it == rollIndex.end() ? NO_POS : it->second;
+}
+
+void clearStudents() {
+    ++rosterVersion;
+    students.clear();
+    namePool.clear();
+    rollIndex.clear();
+    for (auto &col : markColumns) col.clear();
+    clearSecondaryIndexes();
+    clearRankIndex();
+}
+
+// switches the schema under a roster whose markColumns already match names
+void applySubjectSchema(const vector<string> &names) {
+    ++rosterVersion;
+    clearSecondaryIndexes();
+    clearRankIndex();
+    subjectNames = names;
+    numSubjects = (int)names.size();
+    markIndex.assign(names.size(), {});
+    subjectRanks.assign(names.size(), {});
+}
+
+// makes names the active schema and empties the roster; the loaders call it before
+// reading a roster file
+void setSubjectSchema(const vector<string> &names) {
+    clearStudents();
+    markColumns.assign(names.size(), {});
+    applySubjectSchema(names);
+}
+
+// the loaders call this with views straight into the file buffer, so nothing is
+// allocated per field; returns false if the roll is already present
+bool insertStudentFields(int roll, string_view name, string_view parentName, string_view mobile, const float *marks) {
+    if (!rollIndex.emplace(roll, students.size()).second) return false;
+    ++rosterVersion;
+    students.push_back({roll, namePool.intern(name), namePool.intern(parentName), packMobile(mobile)});
+    for (int i = 0; i < numSubjects; ++i) markColumns[i].push_back(marks[i]);
+    if (secondaryIndexesBuilt) indexStudent(students.size() - 1);
+    if (rankIndexBuilt) rankStudent(students.size() - 1, 1);
+    return true;
+}
+
+bool insertStudent(const Student &st) {
+    return insertStudentFields(st.roll, st.name, st.parentName, st.parentMobile, st.marks);
+}
+
+// overwrite an existing record in place, or insert it
+void putStudent(const Student &st) {
+    size_t pos = findPos(st.roll);
+    if (pos == NO_POS) { insertStudent(st); return; }
+    ++rosterVersion;
+    if (secondaryIndexesBuilt) unindexStudent(pos);
+    if (rankIndexBuilt) rankStudent(pos, -1);
+    students[pos] = {st.roll, namePool.intern(st.name), namePool.intern(st.parentName), packMobile(st.parentMobile)};
+    for (int i = 0; i < numSubjects; ++i) markColumns[i][pos] = st.marks[i];
+    if (secondaryIndexesBuilt) indexStudent(pos);
+    if (rankIndexBuilt) rankStudent(pos, 1);
+}
+
+// all mark writes go through here so the mark and rank indexes stay in sync
+void setMark(size_t pos, int subject, float m) {
+    float &cur = markColumns[subject][pos];
+    if (cur == m) return;
+    ++rosterVersion;
+    if (secondaryIndexesBuilt) {
+        markIndex[subject].erase({cur, students[pos].roll});
+        markIndex[subject].emplace(m, students[pos].roll);
+    }
+    if (rankIndexBuilt) rankStudent(pos, -1);
+    cur = m;
+    if (rankIndexBuilt) rankStudent(pos, 1);
+}
+
+// swap-and-pop so a delete never shifts the rest of the vector
+bool removeStudent(int roll) {
+    auto it = rollIndex.find(roll);
+    if (it == rollIndex.end()) return false;
+    size_t pos = it->second;
+    rollIndex.erase(it);
+    ++rosterVersion;
+    if (secondaryIndexesBuilt) unindexStudent(pos);
+    if (rankIndexBuilt) rankStudent(pos, -1);
+    if (pos + 1 != students.size()) {
+        students[pos] = students.back();
+        rollIndex[students[pos].roll] = pos;
+        for (auto &col : markColumns) col[pos] = col.back();
+    }
+    students.pop_back();
+    for (auto &col : markColumns) col.pop_back();
+    return true;
+}
+
+// -------------------- File IO --------------------
+const string STUDENTS_FILE = "students.txt";
+// written by older versions from the per-student complaint field; removed once migrated
+const string COMPLAINTS_FILE = "complaints.txt";
+const string JOURNAL_FILE = "students.journal";
+const string BINARY_FILE = "students.bin";
+// first line of students.txt; a file without it has DEFAULT_SUBJECTS
+const string SUBJECTS_HEADER = "#subjects|";
+
+// set at load time when students.bin is the active snapshot
+bool binarySnapshot = false;
+// --recover-text: an unreadable students.bin is moved aside and students.txt (stale
+// since --to-binary) is loaded instead; without it the load fails
+bool recoverFromText = false;
+
+// journal mode: each mutation appends one record instead of rewriting students.txt
+bool journalMode = true;
+size_t journalRecords = 0;
+const size_t JOURNAL_COMPACT_EVERY = 1000;
+
+// write + fsync; on a crash the file holds at most a torn tail, never a truncated prefix
+bool writeDurable(const string &filename, const string &data, bool append) {
+    recordWrite(filename, data.size());
+#ifdef _WIN32
+    int fd = _open(filename.c_str(), _O_WRONLY | _O_CREAT | _O_BINARY | (append ? _O_APPEND : _O_TRUNC), 0644);
+    if (fd < 0) return false;
+    bool ok = _write(fd, data.data(), (unsigned)data.size()) == (int)data.size() && _commit(fd) == 0;
+    _close(fd);
+#else
+    int fd = open(filename.c_str(), O_WRONLY | O_CREAT | (append ? O_APPEND : O_TRUNC), 0644);
+    if (fd < 0) return false;
+    size_t done = 0;
+    while (done < data.size()) {
+        ssize_t n = write(fd, data.data() + done, data.size() - done);
+        if (n <= 0) { close(fd); return false; }
+        done += (size_t)n;
+    }
+    bool ok = fsync(fd) == 0;
+    close(fd);
+#endif
+    return ok;
+}
+
+// write to a temp file, fsync, then rename over the target
+bool writeFileAtomic(const string &filename, const string &data) {
+    string tmp = filename + ".tmp";
+    if (!writeDurable(tmp, data, false)) return false;
+    error_code ec;
+    filesystem::rename(tmp, filename, ec);
+    return !ec;
+}
+
+void appendStudentLine(string &out, int roll, string_view name, string_view parentName, string_view mobile, const float *marks) {
+    out += to_string(roll);
+    out += '|'; out += name;
+    out += '|'; out += parentName;
+    out += '|'; out += mobile;
+    out += '|';
+    appendMarks(out, marks);
+    out += '|'; // complaint field, kept empty so the line format does not change
+}
+
+string formatStudentLine(const Student &st) {
+    string out;
+    appendStudentLine(out, st.roll, st.name, st.parentName, st.parentMobile, st.marks);
+    return out;
+}
+
+// caller holds storeMutex
+void appendStoredLine(string &out, size_t pos) {
+    const StudentRecord &r = students[pos];
+    char buf[16];
+    float marks[MAX_SUBJECTS];
+    marksAt(pos, marks);
+    appendStudentLine(out, r.roll, nameOf(r), parentNameOf(r), mobileView(r.mobile, buf), marks);
+}
+
+string subjectsHeaderLine() { return SUBJECTS_HEADER + joinSubjects(subjectNames) + "\n"; }
+
+// the schema named by a header line at the front of data, which is then skipped;
+// DEFAULT_SUBJECTS if there is none. Empty string on success, otherwise the reason
+string takeSubjectsHeader(string_view &data, vector<string> &names) {
+    if (data.compare(0, SUBJECTS_HEADER.size(), SUBJECTS_HEADER) != 0) { names = DEFAULT_SUBJECTS; return ""; }
+    size_t nl = data.find('\n');
+    string_view list = data.substr(SUBJECTS_HEADER.size(), nl == string_view::npos ? string_view::npos : nl - SUBJECTS_HEADER.size());
+    data.remove_prefix(nl == string_view::npos ? data.size() : nl + 1);
+    return parseSubjectList(trimView(list), names);
+}
+
+// read-only view of a whole file: mmap where available, one read otherwise;
+// sequential = false for files probed at random rather than scanned
+class MappedFile {
+public:
+    explicit MappedFile(const string &filename, bool sequential = true) {
+#ifndef _WIN32
+        int fd = open(filename.c_str(), O_RDONLY);
+        if (fd < 0) return;
+        struct stat sb;
+        if (fstat(fd, &sb) == 0 && sb.st_size > 0) {
+            void *p = mmap(nullptr, (size_t)sb.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (p != MAP_FAILED) {
+                madvise(p, (size_t)sb.st_size, sequential ? MADV_SEQUENTIAL : MADV_RANDOM);
+                map = p; len = (size_t)sb.st_size;
+            }
+        }
+        close(fd);
+        if (map || sb.st_size == 0) { ok = true; recordRead(filename, len); return; }
+#endif
+        ifstream f(filename, ios::binary);
+        if (!f) return;
+        buf.assign(istreambuf_iterator<char>(f), istreambuf_iterator<char>());
+        ok = true;
+        recordRead(filename, buf.size());
+    }
+    ~MappedFile() {
+#ifndef _WIN32
+        if (map) munmap(map, len);
+#endif
+    }
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+    bool isOpen() const { return ok; }
+    string_view view() const { return map ? string_view((const char *)map, len) : string_view(buf); }
+private:
+    void *map = nullptr;
+    size_t len = 0;
+    string buf;
+    bool ok = false;
+};
+
+// one students.txt line taken apart; the views point into the line
+struct StudentFields {
+    int roll = 0;
+    string_view name, parentName, parentMobile;
+    string_view complaint; // old format only
+    float marks[MAX_SUBJECTS];
+    bool marksOk = true;   // false if the line did not have one mark per subject
+};
+
+// false for malformed lines; tokenizes in place without temporaries
+bool parseStudentFields(string_view raw, StudentFields &st) {
+    string_view line = trimView(raw);
+    if (line.empty()) return false;
+    string_view parts[6];
+    size_t start = 0;
+    for (int i = 0; i < 5; ++i) {
+        size_t bar = line.find('|', start);
+        if (bar == string_view::npos) return false; // malformed
+        parts[i] = line.substr(start, bar - start);
+        start = bar + 1;
+    }
+    parts[5] = line.substr(start);
+    if (parts[5].find('|') != string_view::npos) return false; // malformed
+    string_view rollStr = trimView(parts[0]);
+    if (!isDigitsView(rollStr)) return false;
+    auto rr = from_chars(rollStr.data(), rollStr.data() + rollStr.size(), st.roll);
+    if (rr.ec != errc()) return false;
+    st.name = trimView(parts[1]);
+    st.parentName = trimView(parts[2]);
+    st.parentMobile = trimView(parts[3]);
+    // a wrong count sets all marks to 0 (and marksOk to false), an unparsable mark to 0
+    st.marksOk = parseMarks(parts[4], st.marks);
+    if (!st.marksOk) fill(st.marks, st.marks + numSubjects, 0.0f);
+    st.complaint = trimView(parts[5]);
+    return true;
+}
+
+// complaint, if given, receives the old-format complaint field
+bool parseStudentLine(string_view raw, Student &st, string_view *complaint = nullptr) {
+    StudentFields f;
+    if (!parseStudentFields(raw, f)) return false;
+    st.roll = f.roll;
+    st.name.assign(f.name);
+    st.parentName.assign(f.parentName);
+    st.parentMobile.assign(f.parentMobile);
+    copy(f.marks, f.marks + numSubjects, st.marks);
+    if (complaint) *complaint = f.complaint;
+    return true;
+}
+
+// calls fn(line) for every '\n'-separated line of a buffer
+template <typename Fn>
+void forEachLine(string_view data, Fn fn) {
+    while (!data.empty()) {
+        size_t nl = data.find('\n');
+        fn(data.substr(0, nl));
+        if (nl == string_view::npos) break;
+        data.remove_prefix(nl + 1);
+    }
+}
+
+// -------------------- Binary snapshot --------------------
+/*
+  students.bin layout (host byte order, checked through BIN_BYTE_ORDER):
+    header : magic[8] "SRMSBIN", u32 version, u32 byteOrder, u32 numSubjects,
+             u32 count, u64 poolSize, u32 subjectsLength, u32 reserved
+    subjects: subjectsLength bytes, the subject names separated by ','
+    records: count x { i32 roll, f32 marks[numSubjects], u32 offset[4], u32 length[4] }
+    pool   : name, parentName, parentMobile and complaint bytes, referenced by offset/length
+             (complaint is always empty now; older snapshots may still carry one)
+  Version 1 snapshots end the header at poolSize and have DEFAULT_SUBJECTS.
+*/
+const char BIN_MAGIC[8] = {'S','R','M','S','B','I','N','\0'};
+const uint32_t BIN_VERSION = 2;
+const uint32_t BIN_BYTE_ORDER = 0x01020304;
+const size_t BIN_HEADER_SIZE_V1 = 8 + 4 * 4 + 8;
+const size_t BIN_HEADER_SIZE = BIN_HEADER_SIZE_V1 + 4 + 4;
+
+size_t binRecordSize(int subjects) { return 4 + 4 * (size_t)subjects + 4 * 4 + 4 * 4; }
+
+template <typename T>
+void putRaw(string &out, T v) { out.append((const char *)&v, sizeof(T)); }
+
+template <typename T>
+T getRaw(const char *p) { T v; memcpy(&v, p, sizeof(T)); return v; }
+
+// the roster as stored (caller holds storeMutex); an interned name is written to the
+// pool once and every record using it points at the same bytes
+string encodeBinarySnapshot() {
+    vector<uint32_t> poolOffset(namePool.size(), UINT32_MAX);
+    string pool, records;
+    records.reserve(students.size() * binRecordSize(numSubjects));
+    auto place = [&](uint32_t id) {
+        if (poolOffset[id] == UINT32_MAX) { poolOffset[id] = (uint32_t)pool.size(); pool += namePool.get(id); }
+        return poolOffset[id];
+    };
+    char buf[16];
+    for (size_t pos = 0; pos < students.size(); ++pos) {
+        const StudentRecord &r = students[pos];
+        putRaw<int32_t>(records, r.roll);
+        for (int i = 0; i < numSubjects; ++i) putRaw<float>(records, markColumns[i][pos]);
+        string_view mobile = mobileView(r.mobile, buf);
+        uint32_t offsets[4] = {place(r.name), place(r.parentName), (uint32_t)pool.size(), 0};
+        uint32_t lengths[4] = {(uint32_t)nameOf(r).size(), (uint32_t)parentNameOf(r).size(), (uint32_t)mobile.size(), 0};
+        pool += mobile;
+        for (uint32_t o : offsets) putRaw<uint32_t>(records, o);
+        for (uint32_t l : lengths) putRaw<uint32_t>(records, l);
+    }
+    string subjects = joinSubjects(subjectNames), out;
+    out.reserve(BIN_HEADER_SIZE + subjects.size() + records.size() + pool.size());
+    out.append(BIN_MAGIC, 8);
+    putRaw<uint32_t>(out, BIN_VERSION);
+    putRaw<uint32_t>(out, BIN_BYTE_ORDER);
+    putRaw<uint32_t>(out, numSubjects);
+    putRaw<uint32_t>(out, (uint32_t)students.size());
+    putRaw<uint64_t>(out, pool.size());
+    putRaw<uint32_t>(out, (uint32_t)subjects.size());
+    putRaw<uint32_t>(out, 0);
+    out += subjects;
+    out += records;
+    out += pool;
+    return out;
+}
+
+// the subject names in a snapshot's header and the offset of its first record;
+// false if the buffer does not start with a valid header
+bool readBinaryHeader(string_view data, vector<string> &names, size_t &recordsAt) {
+    if (data.size() < BIN_HEADER_SIZE_V1 || memcmp(data.data(), BIN_MAGIC, 8) != 0) return false;
+    const char *p = data.data() + 8;
+    uint32_t version = getRaw<uint32_t>(p);
+    if ((version != 1 && version != BIN_VERSION) || getRaw<uint32_t>(p + 4) != BIN_BYTE_ORDER) return false;
+    if (version == 1) {
+        names = DEFAULT_SUBJECTS;
+        recordsAt = BIN_HEADER_SIZE_V1;
+    } else {
+        if (data.size() < BIN_HEADER_SIZE) return false;
+        uint64_t length = getRaw<uint32_t>(p + 24);
+        if (data.size() < BIN_HEADER_SIZE + length || !parseSubjectList(data.substr(BIN_HEADER_SIZE, length), names).empty()) return false;
+        recordsAt = BIN_HEADER_SIZE + length;
+    }
+    return getRaw<uint32_t>(p + 8) == names.size();
+}
+
+// calls fn(fields) per record, views pointing into data; false if the buffer is not a
+// valid snapshot of the active schema
+template <typename Fn>
+bool decodeBinarySnapshot(string_view data, Fn fn) {
+    vector<string> names;
+    size_t recordsAt;
+    if (!readBinaryHeader(data, names, recordsAt) || names != subjectNames) return false;
+    const char *p = data.data() + 8;
+    uint64_t count = getRaw<uint32_t>(p + 12);
+    uint64_t poolSize = getRaw<uint64_t>(p + 16);
+    size_t recordSize = binRecordSize(numSubjects);
+    if (data.size() != recordsAt + count * recordSize + poolSize) return false;
+    const char *rec = data.data() + recordsAt;
+    const char *pool = rec + count * recordSize;
+    StudentFields st;
+    for (uint64_t r = 0; r < count; ++r, rec += recordSize) {
+        st.roll = getRaw<int32_t>(rec);
+        memcpy(st.marks, rec + 4, 4 * numSubjects);
+        const char *ref = rec + 4 + 4 * numSubjects;
+        string_view *fields[4] = {&st.name, &st.parentName, &st.parentMobile, &st.complaint};
+        for (int f = 0; f < 4; ++f) {
+            uint64_t off = getRaw<uint32_t>(ref + 4 * f), len = getRaw<uint32_t>(ref + 16 + 4 * f);
+            if (off + len > poolSize) return false;
+            *fields[f] = string_view(pool + off, len);
+        }
+        fn(st);
+    }
+    return true;
+}
+
+// -------------------- Sharded roster --------------------
+// old-format complaint fields seen by the loader, by roll; turned into tickets by
+// migrateLegacyComplaints()
+unordered_map<int, string> legacyComplaints;
+
+void noteLegacyComplaint(int roll, string_view complaint) {
+    if (complaint.empty()) legacyComplaints.erase(roll);
+    else legacyComplaints[roll] = string(complaint);
+}
+
+/*
+  students.d/ holds the roster split by roll range: rolls-<first>.txt has the rolls
+  [first, first + rollsPerShard) in students.txt format, #subjects| header included,
+  and SHARDS records rollsPerShard and the subjects (rollsPerShard=N and
+  subjects=A,B,... lines; without the second, DEFAULT_SUBJECTS). A shard without a
+  header has the subjects of SHARDS. While the directory exists it is the roster (students.txt and
+  students.bin are ignored) and a change rewrites only the shards it touched.
+*/
+const string SHARD_DIR = "students.d";
+const string SHARD_CONFIG = SHARD_DIR + "/SHARDS";
+const int DEFAULT_ROLLS_PER_SHARD = 1000;
+
+bool shardedRoster = false;
+int rollsPerShard = DEFAULT_ROLLS_PER_SHARD;
+// shard numbers (roll / rollsPerShard) changed since they were last written
+set<int> dirtyShards;
+// shard numbers that have a file on disk
+set<int> shardFiles;
+
+int shardOf(int roll) { return roll / rollsPerShard; } // rolls are never negative
+
+string shardFileName(int shard) {
+    return SHARD_DIR + "/rolls-" + to_string((int64_t)shard * rollsPerShard) + ".txt";
+}
+
+void markShardDirty(int roll) { dirtyShards.insert(shardOf(roll)); }
+
+// every shard with a student or a file; used when the layout changes
+void markAllShardsDirty() {
+    for (auto &r : students) dirtyShards.insert(shardOf(r.roll));
+    dirtyShards.insert(shardFiles.begin(), shardFiles.end());
+}
+
+bool writeShardConfig() {
+    return writeFileAtomic(SHARD_CONFIG, "rollsPerShard=" + to_string(rollsPerShard) + "\nsubjects=" + joinSubjects(subjectNames) + "\n");
+}
+
+// rewrites the dirty shards in roll order (caller holds storeMutex); a shard left
+// empty loses its file. Shards that fail to write stay dirty.
+bool saveDirtyShards() {
+    MetricTimer timer(OP_SAVE_SNAPSHOT);
+    set<int> failed;
+    string out, header = subjectsHeaderLine();
+    for (int shard : dirtyShards) {
+        out = header;
+        int64_t first = (int64_t)shard * rollsPerShard, last = min<int64_t>(first + rollsPerShard, (int64_t)INT_MAX + 1);
+        if ((size_t)rollsPerShard <= students.size()) {
+            for (int64_t r = first; r < last; ++r) {
+                size_t pos = findPos((int)r);
+                if (pos != NO_POS) { appendStoredLine(out, pos); out += '\n'; }
+            }
+        } else {
+            vector<size_t> in;
+            for (size_t pos = 0; pos < students.size(); ++pos) if (shardOf(students[pos].roll) == shard) in.push_back(pos);
+            sort(in.begin(), in.end(), [](size_t a, size_t b) { return students[a].roll < students[b].roll; });
+            for (size_t pos : in) { appendStoredLine(out, pos); out += '\n'; }
+        }
+        string file = shardFileName(shard);
+        if (out.size() == header.size()) {
+            error_code ec;
+            if (shardFiles.count(shard) && !filesystem::remove(file, ec) && ec) failed.insert(shard);
+            else shardFiles.erase(shard);
+        } else if (writeFileAtomic(file, out)) shardFiles.insert(shard);
+        else failed.insert(shard);
+    }
+    for (int shard : failed) cout << "⚠ Could not write " << shardFileName(shard) << ".\n";
+    dirtyShards.swap(failed);
+    return dirtyShards.empty();
+}
+
+// loads students.d: the shard files are parsed on a work-stealing pool, then merged
+// into the store in shard order. Duplicate rolls: the lower shard, then the earlier
+// line, wins. A row filed under the wrong range is kept and moved on the next save.
+// changeSubjects rewrites every shard before SHARDS, so shards whose header names
+// other subjects than SHARDS mean it was interrupted; it is finished here. A row
+// without one mark per subject of its file fails the load rather than reading as 0s.
+bool loadShards() {
+    MappedFile config(SHARD_CONFIG);
+    int perShard = 0;
+    vector<string> names = DEFAULT_SUBJECTS;
+    string schemaError;
+    forEachLine(config.isOpen() ? config.view() : string_view(), [&](string_view line) {
+        line = trimView(line);
+        if (line.compare(0, 14, "rollsPerShard=") == 0) from_chars(line.data() + 14, line.data() + line.size(), perShard);
+        else if (line.compare(0, 9, "subjects=") == 0) schemaError = parseSubjectList(line.substr(9), names);
+    });
+    if (perShard <= 0 || !schemaError.empty()) { cout << "❌ " << SHARD_CONFIG << " is missing or invalid.\n"; return false; }
+    rollsPerShard = perShard;
+    setSubjectSchema(names);
+
+    vector<pair<int, string>> files;
+    error_code ec;
+    for (auto &entry : filesystem::directory_iterator(SHARD_DIR, ec)) {
+        string name = entry.path().filename().string();
+        if (name == "SHARDS" || (name.size() > 4 && name.compare(name.size() - 4, 4, ".tmp") == 0)) continue;
+        int64_t first = -1;
+        if (name.compare(0, 6, "rolls-") == 0 && name.size() > 10 && name.compare(name.size() - 4, 4, ".txt") == 0) {
+            string_view digits = string_view(name).substr(6, name.size() - 10);
+            if (isDigitsView(digits)) from_chars(digits.data(), digits.data() + digits.size(), first);
+        }
+        if (first < 0 || first % rollsPerShard != 0 || first / rollsPerShard > INT_MAX) {
+            cout << "⚠ Ignoring " << entry.path().string() << " (not a rolls-<first>.txt shard).\n";
+            continue;
+        }
+        if (!entry.is_regular_file(ec)) { cout << "❌ " << entry.path().string() << " is not a file.\n"; return false; }
+        files.push_back({(int)(first / rollsPerShard), entry.path().string()});
+    }
+    sort(files.begin(), files.end());
+
+    // biggest files are dealt first so the pool finishes together
+    vector<size_t> order(files.size());
+    vector<uintmax_t> sizes(files.size());
+    for (size_t i = 0; i < files.size(); ++i) { order[i] = i; sizes[i] = filesystem::file_size(files[i].second, ec); }
+    sort(order.begin(), order.end(), [&](size_t a, size_t b) { return sizes[a] > sizes[b]; });
+    vector<unique_ptr<MappedFile>> maps(files.size());
+    vector<string_view> bodies(files.size());
+    vector<vector<string>> headers(files.size()); // the file's subjects; empty if they are SHARDS'
+    vector<string> headerErrors(files.size());
+    vector<vector<StudentFields>> rows(files.size());
+    vector<size_t> badRows(files.size()), firstBadLine(files.size());
+    auto parseShard = [&](size_t i) {
+        StudentFields f;
+        size_t lineNo = bodies[i].data() == maps[i]->view().data() ? 0 : 1; // 1 after a header
+        forEachLine(bodies[i], [&](string_view line) {
+            ++lineNo;
+            if (!parseStudentFields(line, f)) return;
+            if (!f.marksOk && !badRows[i]++) firstBadLine[i] = lineNo;
+            rows[i].push_back(f);
+        });
+    };
+    parallelForStealing(files.size(), hardwareThreads(), [&](size_t t) {
+        size_t i = order[t];
+        maps[i] = make_unique<MappedFile>(files[i].second);
+        bodies[i] = maps[i]->view();
+        if (bodies[i].compare(0, SUBJECTS_HEADER.size(), SUBJECTS_HEADER) == 0) {
+            headerErrors[i] = takeSubjectsHeader(bodies[i], headers[i]);
+            if (headers[i] == subjectNames) headers[i].clear();
+        }
+        if (headers[i].empty() && headerErrors[i].empty()) parseShard(i); // the rest once the subjects are settled
+    });
+    // an unreadable shard taken as empty would be overwritten by its next save
+    bool readable = true;
+    for (size_t i = 0; i < files.size(); ++i) {
+        if (!maps[i]->isOpen()) { cout << "❌ Cannot read " << files[i].second << ".\n"; readable = false; }
+        else if (!headerErrors[i].empty()) { cout << "❌ " << files[i].second << ": " << headerErrors[i] << ".\n"; readable = false; }
+    }
+    if (!readable) return false;
+
+    // finish an interrupted change of subjects: the other shards' marks move by subject name
+    vector<string> target;
+    for (size_t i = 0; i < files.size(); ++i) {
+        if (headers[i].empty()) continue;
+        if (!target.empty() && headers[i] != target) {
+            cout << "❌ " << SHARD_DIR << " mixes the subjects " << joinSubjects(target) << " and " << joinSubjects(headers[i]) << ".\n";
+            return false;
+        }
+        target = headers[i];
+    }
+    if (!target.empty()) {
+        vector<int> from(target.size());
+        for (size_t j = 0; j < target.size(); ++j) {
+            auto it = find(subjectNames.begin(), subjectNames.end(), target[j]);
+            from[j] = it == subjectNames.end() ? -1 : (int)(it - subjectNames.begin());
+        }
+        float old[MAX_SUBJECTS];
+        for (auto &shardRows : rows)
+            for (auto &f : shardRows) {
+                copy(f.marks, f.marks + numSubjects, old);
+                for (size_t j = 0; j < target.size(); ++j) f.marks[j] = from[j] < 0 ? 0.0f : old[from[j]];
+            }
+        setSubjectSchema(target);
+        vector<size_t> rest;
+        for (size_t i = 0; i < files.size(); ++i) if (!headers[i].empty()) rest.push_back(i);
+        parallelForStealing(rest.size(), hardwareThreads(), [&](size_t t) { parseShard(rest[t]); });
+    }
+    bool complete = true;
+    for (size_t i = 0; i < files.size(); ++i)
+        if (badRows[i]) {
+            cout << "❌ " << files[i].second << ": " << badRows[i] << " row(s) without one mark per subject, the first on line "
+                 << firstBadLine[i] << ".\n";
+            complete = false;
+        }
+    if (!complete) return false;
+
+    size_t total = 0;
+    for (auto &r : rows) total += r.size();
+    students.reserve(total);
+    rollIndex.reserve(total);
+    for (auto &c : markColumns) c.reserve(total);
+    for (size_t i = 0; i < files.size(); ++i) {
+        shardFiles.insert(files[i].first);
+        for (auto &f : rows[i]) {
+            if (shardOf(f.roll) != files[i].first) { dirtyShards.insert(files[i].first); markShardDirty(f.roll); }
+            if (insertStudentFields(f.roll, f.name, f.parentName, f.parentMobile, f.marks)) noteLegacyComplaint(f.roll, f.complaint);
+        }
+    }
+    if (!target.empty()) {
+        markAllShardsDirty();
+        if (!saveDirtyShards() || !writeShardConfig()) {
+            cout << "❌ Could not finish the interrupted change of subjects to " << joinSubjects(target) << ".\n";
+            return false;
+        }
+        cout << "✔ Finished an interrupted change of subjects: they are now " << joinSubjects(target) << ".\n";
+    }
+    return true;
+}
+
+// -------------------- Persistence --------------------
+// full snapshot: students.txt (or students.bin); sharded, only the dirty shards.
+// false if a file could not be written
+bool saveStudentsToFiles() {
+    if (shardedRoster) return saveDirtyShards();
+    MetricTimer timer(OP_SAVE_SNAPSHOT);
+    if (binarySnapshot) return writeFileAtomic(BINARY_FILE, encodeBinarySnapshot());
+    string sOut = subjectsHeaderLine();
+    sOut.reserve(students.size() * 64);
+    for (size_t pos = 0; pos < students.size(); ++pos) { appendStoredLine(sOut, pos); sOut += '\n'; }
+    return writeFileAtomic(STUDENTS_FILE, sOut);
+}
+
+// fold the journal into a fresh snapshot and empty it; the journal is kept if the
+// snapshot could not be written
+bool compactJournal() {
+    if (!saveStudentsToFiles()) return false;
+    if (filesystem::exists(JOURNAL_FILE)) writeDurable(JOURNAL_FILE, "", false);
+    journalRecords = 0;
+    return true;
+}
+
+void appendJournal(const string &record) {
+    MetricTimer timer(OP_JOURNAL_APPEND);
+    if (!writeDurable(JOURNAL_FILE, record + "\n", true)) {
+        cout << "⚠ Journal write failed, saving full snapshot instead.\n";
+        compactJournal();
+        return;
+    }
+    if (++journalRecords >= JOURNAL_COMPACT_EVERY) compactJournal();
+}
+
+// batch mode: mutations only mark the roster dirty and flushPersistence() writes it once
+bool deferPersist = false;
+bool rosterDirty = false;
+
+// call after a student was added or changed in memory
+void persistStudent(const Student &st) {
+    if (shardedRoster) markShardDirty(st.roll);
+    if (deferPersist) rosterDirty = true;
+    else if (shardedRoster) saveDirtyShards();
+    else if (journalMode) appendJournal("P|" + formatStudentLine(st));
+    else compactJournal();
+}
+
+// call after a student was removed from memory
+void persistDelete(int roll) {
+    if (shardedRoster) markShardDirty(roll);
+    if (deferPersist) rosterDirty = true;
+    else if (shardedRoster) saveDirtyShards();
+    else if (journalMode) appendJournal("D|" + to_string(roll));
+    else compactJournal();
+}
+
+void replayJournal() {
+    MappedFile jIn(JOURNAL_FILE);
+    if (!jIn.isOpen()) return;
+    string data(jIn.view());
+    size_t pos = 0, validEnd = 0;
+    while (true) {
+        size_t nl = data.find('\n', pos);
+        if (nl == string::npos) break; // unterminated tail = torn write, ignored
+        string rec = data.substr(pos, nl - pos);
+        pos = validEnd = nl + 1;
+        if (rec.size() < 2 || rec[1] != '|') continue;
+        if (rec[0] == 'P') {
+            Student st;
+            string_view complaint;
+            if (!parseStudentLine(string_view(rec).substr(2), st, &complaint)) continue;
+            putStudent(st);
+            noteLegacyComplaint(st.roll, complaint);
+        } else if (rec[0] == 'D') {
+            string_view r = trimView(string_view(rec).substr(2));
+            int roll;
+            if (!isDigitsView(r) || from_chars(r.data(), r.data() + r.size(), roll).ec != errc()) continue; // malformed
+            removeStudent(roll);
+            legacyComplaints.erase(roll);
+        } else continue;
+        ++journalRecords;
+    }
+    // cut the torn tail so later appends start on a clean line
+    if (validEnd < data.size()) {
+        error_code ec;
+        filesystem::resize_file(JOURNAL_FILE, validEnd, ec);
+    }
+}
+
+// snapshot first, then the journal on top of it
+void loadStudentsFromFiles() {
+    MetricTimer timer(OP_LOAD_STUDENTS);
+    clearStudents();
+    legacyComplaints.clear();
+    journalRecords = 0;
+    dirtyShards.clear();
+    shardFiles.clear();
+    shardedRoster = filesystem::is_directory(SHARD_DIR);
+    if (shardedRoster && !loadShards()) {
+        // students.txt is as old as the last --to-shards; starting from it would lose every change since
+        cout << "❌ Could not load " << SHARD_DIR << ". Restore the files above and start again.\n";
+        exit(1);
+    }
+    binarySnapshot = !shardedRoster && filesystem::exists(BINARY_FILE);
+    if (binarySnapshot) {
+        MappedFile bIn(BINARY_FILE);
+        auto add = [](const StudentFields &f) {
+            if (insertStudentFields(f.roll, f.name, f.parentName, f.parentMobile, f.marks)) noteLegacyComplaint(f.roll, f.complaint);
+        };
+        vector<string> names;
+        size_t recordsAt;
+        if (readBinaryHeader(bIn.view(), names, recordsAt)) setSubjectSchema(names);
+        if (!decodeBinarySnapshot(bIn.view(), add)) {
+            // students.txt is older than the snapshot; saving it would lose every change since
+            if (!recoverFromText) {
+                cout << "❌ " << BINARY_FILE << " is not a valid snapshot. Restore it, or run with --recover-text to load "
+                     << STUDENTS_FILE << " (as of the last --to-binary) instead.\n";
+                exit(1);
+            }
+            error_code ec;
+            filesystem::rename(BINARY_FILE, BINARY_FILE + ".corrupt", ec);
+            if (ec) { cout << "❌ Could not move " << BINARY_FILE << " aside: " << ec.message() << ".\n"; exit(1); }
+            cout << "⚠ " << BINARY_FILE << " is not a valid snapshot; moved to " << BINARY_FILE << ".corrupt, using " << STUDENTS_FILE << ".\n";
+            clearStudents();
+            legacyComplaints.clear();
+            binarySnapshot = false;
+        }
+    }
+    if (!binarySnapshot && !shardedRoster) {
+        MappedFile sIn(STUDENTS_FILE);
+        string_view data = sIn.isOpen() ? sIn.view() : string_view();
+        vector<string> names;
+        string err = takeSubjectsHeader(data, names);
+        if (!err.empty()) {
+            // loading the lines under any other schema would lose their marks on the next save
+            cout << "❌ " << STUDENTS_FILE << ": invalid subject list (" << err << ").\n";
+            exit(1);
+        }
+        setSubjectSchema(names);
+        if (sIn.isOpen()) {
+            StudentFields f;
+            forEachLine(data, [&](string_view line) {
+                // duplicate rolls: first line wins
+                if (parseStudentFields(line, f) && insertStudentFields(f.roll, f.name, f.parentName, f.parentMobile, f.marks))
+                    noteLegacyComplaint(f.roll, f.complaint);
+            });
+        }
+    }
+    replayJournal();
+    // a journal left from before the roster was sharded: fold it into the shards
+    if (shardedRoster && journalRecords > 0) { markAllShardsDirty(); compactJournal(); }
+}
+
+// usage: srms --to-binary | --to-text; converts the loaded roster (snapshot + journal)
+bool convertSnapshot(bool toBinary) {
+    binarySnapshot = toBinary;
+    bool wasSharded = shardedRoster;
+    shardedRoster = false;
+    if (!compactJournal()) {
+        cout << "❌ Could not write " << (toBinary ? BINARY_FILE : STUDENTS_FILE) << "; nothing was removed.\n";
+        return false;
+    }
+    error_code ec;
+    if (!toBinary) filesystem::remove(BINARY_FILE, ec);
+    if (wasSharded) filesystem::remove_all(SHARD_DIR, ec);
+    cout << "✔ " << students.size() << " students written to " << (toBinary ? BINARY_FILE : STUDENTS_FILE) << ".\n";
+    if (toBinary) cout << STUDENTS_FILE << " is ignored while " << BINARY_FILE << " exists.\n";
+    return true;
+}
+
+// splits the loaded roster into students.d with the given shard width; files of an
+// older width are removed once the new ones are written
+bool writeShards(int perShard) {
+    vector<string> oldFiles;
+    for (int shard : shardFiles) oldFiles.push_back(shardFileName(shard));
+    error_code ec;
+    filesystem::create_directories(SHARD_DIR, ec);
+    rollsPerShard = perShard;
+    shardedRoster = true;
+    binarySnapshot = false;
+    shardFiles.clear();
+    dirtyShards.clear();
+    markAllShardsDirty();
+    if (!writeShardConfig() || !saveDirtyShards()) return false;
+    if (filesystem::exists(JOURNAL_FILE)) writeDurable(JOURNAL_FILE, "", false);
+    journalRecords = 0;
+    set<string> current;
+    for (int shard : shardFiles) current.insert(shardFileName(shard));
+    for (auto &f : oldFiles) if (!current.count(f)) filesystem::remove(f, ec);
+    return true;
+}
+
+// usage: srms --to-shards [rollsPerShard]
+bool convertToShards(int perShard) {
+    if (!writeShards(perShard)) { cout << "❌ Could not write " << SHARD_DIR << ".\n"; return false; }
+    cout << "✔ " << students.size() << " students written to " << shardFiles.size() << " shards in " << SHARD_DIR << "/.\n";
+    cout << STUDENTS_FILE << " and " << BINARY_FILE << " are ignored while " << SHARD_DIR << " exists.\n";
+    return true;
+}
+
+// usage: srms --set-subjects "A,B,..."; a subject that keeps its name keeps its marks,
+// a new one starts at 0 for everyone and a dropped one loses them. The loaded roster
+// is rewritten in its current format with the new header.
+bool changeSubjects(const string &list) {
+    vector<string> names;
+    string err = parseSubjectList(list, names);
+    if (!err.empty()) { cout << "❌ Invalid subject list: " << err << ".\n"; return false; }
+    if (names == subjectNames) { cout << "Subjects unchanged: " << joinSubjects(names) << ".\n"; return true; }
+    vector<vector<float>> columns(names.size());
+    vector<string> added, dropped;
+    for (size_t j = 0; j < names.size(); ++j) {
+        auto it = find(subjectNames.begin(), subjectNames.end(), names[j]);
+        if (it == subjectNames.end()) { columns[j].assign(students.size(), 0.0f); added.push_back(names[j]); }
+        else columns[j] = std::move(markColumns[it - subjectNames.begin()]);
+    }
+    for (auto &old : subjectNames) if (find(names.begin(), names.end(), old) == names.end()) dropped.push_back(old);
+    markColumns = std::move(columns);
+    applySubjectSchema(names);
+    // shards first, SHARDS last; each shard names its subjects, so loadShards() finishes
+    // the change if it is cut short in between
+    if (shardedRoster) markAllShardsDirty();
+    if (!compactJournal() || (shardedRoster && !writeShardConfig())) {
+        cout << "❌ Could not save the roster with the new subjects; the data files may be incomplete.\n";
+        return false;
+    }
+    cout << "✔ Subjects are now " << joinSubjects(names) << " (" << students.size() << " students rewritten).\n";
+    if (!added.empty()) cout << "Added with marks 0: " << joinSubjects(added) << "\n";
+    if (!dropped.empty()) cout << "⚠ Marks discarded for: " << joinSubjects(dropped) << "\n";
+    return true;
+}
+
+// -------------------- Load benchmark --------------------
+// previous getline/split/stof loader, kept only as the --bench-load baseline
+bool parseStudentLineLegacy(const string &raw, Student &st) {
+    string line = trim(raw);
+    if (line.empty()) return false;
+    vector<string> parts = split(line, '|');
+    if (parts.size() != 6) return false; // malformed
+    string rollStr = trim(parts[0]);
+    if (!isDigits(rollStr)) return false;
+    st.roll = stoi(rollStr);
+    st.name = trim(parts[1]);
+    st.parentName = trim(parts[2]);
+    st.parentMobile = trim(parts[3]);
+    // parse marks
+    vector<string> mparts = split(parts[4], ',');
+    if ((int)mparts.size() != numSubjects) {
+        // if missing, set to 0
+        for (int i = 0; i < numSubjects; ++i) st.marks[i] = 0;
+    } else {
+        for (int i = 0; i < numSubjects; ++i) {
+            string ms = trim(mparts[i]);
+            try {
+                st.marks[i] = stof(ms);
+            } catch (...) { st.marks[i] = 0; }
+        }
+    }
+    return true;
+}
+
+size_t loadStudentsLegacy(const string &filename, vector<Student> &out) {
+    ifstream sIn(filename);
+    string line;
+    while (getline(sIn, line)) {
+        Student st;
+        if (parseStudentLineLegacy(line, st)) out.push_back(st);
+    }
+    return out.size();
+}
+
+size_t loadStudentsMapped(const string &filename, vector<Student> &out) {
+    MappedFile sIn(filename);
+    Student st;
+    forEachLine(sIn.view(), [&](string_view line) {
+        if (parseStudentLine(line, st)) out.push_back(st);
+    });
+    return out.size();
+}
+
+// usage: srms --bench-load [file] [runs]
+void benchLoad(const string &filename, int runs) {
+    auto timeIt = [&](size_t (*loader)(const string &, vector<Student> &), size_t &rows) {
+        double best = 1e18;
+        for (int i = 0; i < runs; ++i) {
+            vector<Student> v;
+            auto t0 = chrono::steady_clock::now();
+            rows = loader(filename, v);
+            double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - t0).count();
+            best = min(best, ms);
+        }
+        return best;
+    };
+    size_t legacyRows = 0, mappedRows = 0;
+    double legacyMs = timeIt(loadStudentsLegacy, legacyRows);
+    double mappedMs = timeIt(loadStudentsMapped, mappedRows);
+    cout << "file: " << filename << " (best of " << runs << ")\n";
+    cout << "legacy getline/split loader: " << legacyRows << " rows in " << legacyMs << " ms\n";
+    cout << "mmap string_view loader    : " << mappedRows << " rows in " << mappedMs << " ms\n";
+    if (mappedMs > 0) cout << "speedup: " << legacyMs / mappedMs << "x\n";
+}
+
+// -------------------- Complaint tickets --------------------
+/*
+  complaints.log, append-only, one fsync'd record per change:
+    O|id|roll|priority|openedAt|text    ticket opened (priority 1 high, 2 normal, 3 low)
+    R|id|resolvedAt                     ticket resolved
+  Times are Unix seconds. Ids count up from 1, so tickets[id - 1] is the ticket
+  and a lower id is an older ticket. Open tickets are also kept in two ordered
+  sets, so the queue is read oldest-first or priority-first without touching
+  resolved tickets or the roster. A torn last record is ignored, as for the journal.
+*/
+const string COMPLAINT_LOG = "complaints.log";
+
+enum TicketPriority { PRIORITY_HIGH = 1, PRIORITY_NORMAL = 2, PRIORITY_LOW = 3 };
+const char *PRIORITY_NAMES[] = {"", "high", "normal", "low"};
+
+struct Ticket {
+    uint32_t id = 0;
+    int roll = 0;
+    int priority = PRIORITY_NORMAL;
+    int64_t openedAt = 0;
+    int64_t resolvedAt = 0; // 0 while open
+    string text;
+    bool isOpen() const { return resolvedAt == 0; }
+};
+
+vector<Ticket> tickets;
+set<uint32_t> openByAge;
+set<pair<int, uint32_t>> openByPriority;
+unordered_map<int, vector<uint32_t>> ticketsByRoll;
+// guards the ticket store, pendingTicketRecords and complaints.log
+shared_mutex ticketMutex;
+// log records queued while deferPersist is set
+string pendingTicketRecords;
+
+int64_t nowSeconds() { return (int64_t)time(nullptr); }
+
+string formatTime(int64_t t) {
+    time_t tt = (time_t)t;
+    tm parts{};
+#ifdef _WIN32
+    localtime_s(&parts, &tt);
+#else
+    localtime_r(&tt, &parts);
+#endif
+    char buf[32];
+    strftime(buf, sizeof(buf), "%Y-%m-%d %H:%M", &parts);
+    return buf;
+}
+
+// the low-level functions below expect the caller to hold ticketMutex exclusively
+void applyOpen(Ticket t) {
+    uint32_t id = t.id;
+    if (t.isOpen()) { openByAge.insert(id); openByPriority.emplace(t.priority, id); }
+    ticketsByRoll[t.roll].push_back(id);
+    tickets.push_back(std::move(t));
+}
+
+bool applyResolve(uint32_t id, int64_t at) {
+    if (id == 0 || id > tickets.size() || !tickets[id - 1].isOpen()) return false;
+    Ticket &t = tickets[id - 1];
+    t.resolvedAt = at;
+    openByAge.erase(id);
+    openByPriority.erase({t.priority, id});
+    return true;
+}
+
+void appendTicketRecord(const string &rec) {
+    if (deferPersist) { pendingTicketRecords += rec; return; }
+    if (!writeDurable(COMPLAINT_LOG, rec, true)) cout << "⚠ Could not write " << COMPLAINT_LOG << ".\n";
+}
+
+// takes the next '|'-separated field off the front of rest
+string_view nextField(string_view &rest) {
+    size_t bar = rest.find('|');
+    string_view f = rest.substr(0, bar);
+    rest = bar == string_view::npos ? string_view() : rest.substr(bar + 1);
+    return f;
+}
+
+template <typename T>
+bool parseIntView(string_view s, T &out) {
+    s = trimView(s);
+    return !s.empty() && from_chars(s.data(), s.data() + s.size(), out).ec == errc();
+}
+
+void applyTicketRecord(string_view rec) {
+    string_view kind = nextField(rec);
+    uint32_t id;
+    if (!parseIntView(nextField(rec), id)) return;
+    if (kind == "O") {
+        Ticket t;
+        t.id = id;
+        if (id != tickets.size() + 1) return; // ids are dense; anything else is damage
+        if (!parseIntView(nextField(rec), t.roll) || !parseIntView(nextField(rec), t.priority)
+            || !parseIntView(nextField(rec), t.openedAt)) return;
+        if (t.priority < PRIORITY_HIGH || t.priority > PRIORITY_LOW) t.priority = PRIORITY_NORMAL;
+        t.text.assign(rec);
+        applyOpen(std::move(t));
+    } else if (kind == "R") {
+        int64_t at;
+        if (parseIntView(nextField(rec), at)) applyResolve(id, at);
+    }
+}
+
+void loadTicketLog() {
+    unique_lock<shared_mutex> lk(ticketMutex);
+    tickets.clear(); openByAge.clear(); openByPriority.clear(); ticketsByRoll.clear();
+    size_t size = 0, validEnd = 0;
+    {
+        MappedFile f(COMPLAINT_LOG);
+        if (!f.isOpen()) return;
+        string_view data = f.view();
+        size = data.size();
+        while (validEnd < size) {
+            size_t nl = data.find('\n', validEnd);
+            if (nl == string_view::npos) break; // unterminated tail = torn write, ignored
+            applyTicketRecord(data.substr(validEnd, nl - validEnd));
+            validEnd = nl + 1;
+        }
+    }
+    if (validEnd < size) {
+        error_code ec;
+        filesystem::resize_file(COMPLAINT_LOG, validEnd, ec);
+    }
+}
+
+// opens a ticket without checking the roll (see raiseComplaint); returns its id
+uint32_t openTicket(int roll, string text, int priority) {
+    MetricTimer timer(OP_COMPLAINT);
+    replace(text.begin(), text.end(), '\n', ' ');
+    replace(text.begin(), text.end(), '\r', ' ');
+    unique_lock<shared_mutex> lk(ticketMutex);
+    Ticket t;
+    t.id = (uint32_t)tickets.size() + 1;
+    t.roll = roll;
+    t.priority = priority;
+    t.openedAt = nowSeconds();
+    t.text = std::move(text);
+    appendTicketRecord("O|" + to_string(t.id) + "|" + to_string(roll) + "|" + to_string(priority) + "|"
+                       + to_string(t.openedAt) + "|" + t.text + "\n");
+    uint32_t id = t.id;
+    applyOpen(std::move(t));
+    return id;
+}
+
+// false if there is no such ticket or it was already resolved
+bool resolveTicket(uint32_t id) {
+    MetricTimer timer(OP_COMPLAINT);
+    unique_lock<shared_mutex> lk(ticketMutex);
+    int64_t now = nowSeconds();
+    if (!applyResolve(id, now)) return false;
+    appendTicketRecord("R|" + to_string(id) + "|" + to_string(now) + "\n");
+    return true;
+}
+
+// resolves every open ticket of a roll; returns how many there were
+size_t resolveTicketsForRoll(int roll) {
+    unique_lock<shared_mutex> lk(ticketMutex);
+    auto it = ticketsByRoll.find(roll);
+    if (it == ticketsByRoll.end()) return 0;
+    int64_t now = nowSeconds();
+    string recs;
+    size_t n = 0;
+    for (uint32_t id : it->second)
+        if (applyResolve(id, now)) { recs += "R|" + to_string(id) + "|" + to_string(now) + "\n"; ++n; }
+    if (n) appendTicketRecord(recs);
+    return n;
+}
+
+// every ticket of a roll, oldest first
+vector<Ticket> ticketsForRoll(int roll) {
+    shared_lock<shared_mutex> lk(ticketMutex);
+    vector<Ticket> out;
+    auto it = ticketsByRoll.find(roll);
+    if (it != ticketsByRoll.end())
+        for (uint32_t id : it->second) out.push_back(tickets[id - 1]);
+    return out;
+}
+
+size_t openTicketCount() {
+    shared_lock<shared_mutex> lk(ticketMutex);
+    return openByAge.size();
+}
+
+// up to limit open tickets after the cursor ticket (0 = from the start),
+// oldest first or highest priority first (oldest first within a priority)
+vector<Ticket> openTicketPage(bool byPriority, uint32_t afterId, size_t limit) {
+    shared_lock<shared_mutex> lk(ticketMutex);
+    vector<Ticket> out;
+    if (byPriority) {
+        auto it = afterId ? openByPriority.upper_bound({tickets[afterId - 1].priority, afterId}) : openByPriority.begin();
+        for (; it != openByPriority.end() && out.size() < limit; ++it) out.push_back(tickets[it->second - 1]);
+    } else {
+        for (auto it = openByAge.upper_bound(afterId); it != openByAge.end() && out.size() < limit; ++it)
+            out.push_back(tickets[*it - 1]);
+    }
+    return out;
+}
+
+// complaint fields from older data files become normal-priority tickets; a ticket
+// with the same text already open for the roll means it was migrated before
+size_t migrateLegacyComplaints() {
+    vector<pair<int, string>> legacy(legacyComplaints.begin(), legacyComplaints.end());
+    legacyComplaints.clear();
+    sort(legacy.begin(), legacy.end());
+    size_t migrated = 0;
+    for (auto &lc : legacy) {
+        bool seen = false;
+        for (auto &t : ticketsForRoll(lc.first)) if (t.isOpen() && t.text == lc.second) seen = true;
+        if (!seen) { openTicket(lc.first, lc.second, PRIORITY_NORMAL); ++migrated; }
+    }
+    return migrated;
+}
+
+// -------------------- Password hashing --------------------
+// SHA-256 (FIPS 180-4), HMAC-SHA256 and PBKDF2-HMAC-SHA256 (RFC 8018), self-contained
+struct Sha256 {
+    uint32_t h[8];
+    uint8_t block[64];
+    uint64_t length = 0;
+    size_t used = 0;
+
+    Sha256() { reset(); }
+    void reset() {
+        static const uint32_t init[8] = {0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+                                         0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19};
+        memcpy(h, init, sizeof h);
+        length = 0; used = 0;
+    }
+    static uint32_t rotr(uint32_t x, int n) { return (x >> n) | (x << (32 - n)); }
+    static void compress(uint32_t *state, const uint8_t *p) {
+        static const uint32_t k[64] = {
+            0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+            0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+            0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+            0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+            0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+            0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+            0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+            0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2};
+        uint32_t w[64];
+        for (int i = 0; i < 16; ++i)
+            w[i] = (uint32_t)p[4 * i] << 24 | (uint32_t)p[4 * i + 1] << 16 | (uint32_t)p[4 * i + 2] << 8 | p[4 * i + 3];
+        for (int i = 16; i < 64; ++i) {
+            uint32_t s0 = rotr(w[i - 15], 7) ^ rotr(w[i - 15], 18) ^ (w[i - 15] >> 3);
+            uint32_t s1 = rotr(w[i - 2], 17) ^ rotr(w[i - 2], 19) ^ (w[i - 2] >> 10);
+            w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+        }
+        uint32_t a = state[0], b = state[1], c = state[2], d = state[3], e = state[4], f = state[5], g = state[6], hh = state[7];
+        for (int i = 0; i < 64; ++i) {
+            uint32_t t1 = hh + (rotr(e, 6) ^ rotr(e, 11) ^ rotr(e, 25)) + ((e & f) ^ (~e & g)) + k[i] + w[i];
+            uint32_t t2 = (rotr(a, 2) ^ rotr(a, 13) ^ rotr(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+            hh = g; g = f; f = e; e = d + t1; d = c; c = b; b = a; a = t1 + t2;
+        }
+        state[0] += a; state[1] += b; state[2] += c; state[3] += d;
+        state[4] += e; state[5] += f; state[6] += g; state[7] += hh;
+    }
+    void update(const void *data, size_t n) {
+        const uint8_t *p = (const uint8_t *)data;
+        length += n;
+        while (n > 0) {
+            size_t take = min(n, 64 - used);
+            memcpy(block + used, p, take);
+            used += take; p += take; n -= take;
+            if (used == 64) { compress(h, block); used = 0; }
+        }
+    }
+    void final(uint8_t *out) {
+        uint64_t bits = length * 8;
+        uint8_t pad = 0x80;
+        update(&pad, 1);
+        pad = 0;
+        while (used != 56) update(&pad, 1);
+        uint8_t len[8];
+        for (int i = 0; i < 8; ++i) len[i] = (uint8_t)(bits >> (56 - 8 * i));
+        update(len, 8);
+        for (int i = 0; i < 8; ++i) for (int j = 0; j < 4; ++j) out[4 * i + j] = (uint8_t)(h[i] >> (24 - 8 * j));
+    }
+};
+
+// HMAC-SHA256 with the inner and outer key states computed once, so every further
+// message costs only the compressions of the message itself
+struct HmacSha256 {
+    Sha256 inner, outer;
+    explicit HmacSha256(string_view key) {
+        uint8_t k[64] = {0}, pad[64];
+        if (key.size() > 64) { Sha256 s; s.update(key.data(), key.size()); s.final(k); }
+        else memcpy(k, key.data(), key.size());
+        for (int i = 0; i < 64; ++i) pad[i] = k[i] ^ 0x36;
+        inner.update(pad, 64);
+        for (int i = 0; i < 64; ++i) pad[i] = k[i] ^ 0x5c;
+        outer.update(pad, 64);
+    }
+    void mac(const void *data, size_t n, uint8_t *out) const {
+        Sha256 s = inner;
+        s.update(data, n);
+        uint8_t ih[32];
+        s.final(ih);
+        Sha256 o = outer;
+        o.update(ih, 32);
+        o.final(out);
+    }
+};
+
+// PBKDF2-HMAC-SHA256 with a 32-byte output (one block). Each iteration hashes one
+// 32-byte value, so the padded blocks are built once and the loop is two compressions.
+void pbkdf2Sha256(string_view password, const uint8_t *salt, size_t saltLen, uint32_t iterations, uint8_t *out) {
+    HmacSha256 hmac(password);
+    string first((const char *)salt, saltLen);
+    first += string("\0\0\0\1", 4);
+    uint8_t u[32];
+    hmac.mac(first.data(), first.size(), u);
+    memcpy(out, u, 32);
+    // message block: 32 bytes of data, 0x80, zeros, length (64 + 32 bytes) * 8 bits
+    uint8_t blk[64] = {0};
+    blk[32] = 0x80;
+    blk[62] = 0x03; // 768 bits
+    for (uint32_t it = 1; it < iterations; ++it) {
+        uint32_t st[8];
+        memcpy(blk, u, 32);
+        memcpy(st, hmac.inner.h, sizeof st);
+        Sha256::compress(st, blk);
+        for (int i = 0; i < 8; ++i) for (int j = 0; j < 4; ++j) blk[4 * i + j] = (uint8_t)(st[i] >> (24 - 8 * j));
+        memcpy(st, hmac.outer.h, sizeof st);
+        Sha256::compress(st, blk);
+        for (int i = 0; i < 8; ++i) for (int j = 0; j < 4; ++j) u[4 * i + j] = (uint8_t)(st[i] >> (24 - 8 * j));
+        for (int i = 0; i < 32; ++i) out[i] ^= u[i];
+    }
+}
+
+// stored form: $pbkdf2-sha256$<iterations>$<salt hex>$<digest hex>
+struct PasswordHash {
+    uint32_t iterations = 0;
+    uint8_t salt[16];
+    uint8_t digest[32];
+};
+
+const string HASH_PREFIX = "$pbkdf2-sha256$";
+// cost of new hashes; --hash-iterations changes it. Existing entries keep the cost
+// they were written with.
+const uint32_t DEFAULT_HASH_ITERATIONS = 10000;
+uint32_t hashIterations = DEFAULT_HASH_ITERATIONS;
+
+void fillRandom(uint8_t *out, size_t n) {
+    thread_local random_device rd;
+    for (size_t i = 0; i < n; i += 4) {
+        uint32_t v = rd();
+        for (size_t j = i; j < n && j < i + 4; ++j, v >>= 8) out[j] = (uint8_t)v;
+    }
+}
+
+string hexEncode(const uint8_t *p, size_t n) {
+    static const char digits[] = "0123456789abcdef";
+    string out(2 * n, '0');
+    for (size_t i = 0; i < n; ++i) { out[2 * i] = digits[p[i] >> 4]; out[2 * i + 1] = digits[p[i] & 15]; }
+    return out;
+}
+
+bool hexDecode(string_view hex, uint8_t *out, size_t n) {
+    if (hex.size() != 2 * n) return false;
+    auto nibble = [](char c) { return c >= '0' && c <= '9' ? c - '0' : c >= 'a' && c <= 'f' ? c - 'a' + 10 : -1; };
+    for (size_t i = 0; i < n; ++i) {
+        int hi = nibble(hex[2 * i]), lo = nibble(hex[2 * i + 1]);
+        if (hi < 0 || lo < 0) return false;
+        out[i] = (uint8_t)(hi << 4 | lo);
+    }
+    return true;
+}
+
+bool isPasswordHash(string_view stored) { return stored.compare(0, HASH_PREFIX.size(), HASH_PREFIX) == 0; }
+
+// salt, if given, is 16 bytes; otherwise a random one is drawn
+PasswordHash hashPassword(string_view password, uint32_t iterations = hashIterations, const uint8_t *salt = nullptr) {
+    PasswordHash h;
+    h.iterations = max(1u, iterations);
+    if (salt) memcpy(h.salt, salt, sizeof h.salt);
+    else fillRandom(h.salt, sizeof h.salt);
+    pbkdf2Sha256(password, h.salt, sizeof h.salt, h.iterations, h.digest);
+    return h;
+}
+
+string encodePasswordHash(const PasswordHash &h) {
+    return HASH_PREFIX + to_string(h.iterations) + "$" + hexEncode(h.salt, sizeof h.salt) + "$" + hexEncode(h.digest, sizeof h.digest);
+}
+
+bool decodePasswordHash(string_view stored, PasswordHash &h) {
+    if (!isPasswordHash(stored)) return false;
+    stored.remove_prefix(HASH_PREFIX.size());
+    size_t d1 = stored.find('$'), d2 = stored.find('$', d1 == string_view::npos ? d1 : d1 + 1);
+    if (d2 == string_view::npos) return false;
+    string_view iters = stored.substr(0, d1);
+    auto r = from_chars(iters.data(), iters.data() + iters.size(), h.iterations);
+    return r.ec == errc() && r.ptr == iters.data() + iters.size() && h.iterations > 0
+        && hexDecode(stored.substr(d1 + 1, d2 - d1 - 1), h.salt, sizeof h.salt)
+        && hexDecode(stored.substr(d2 + 1), h.digest, sizeof h.digest);
+}
+
+// the comparison does not stop at the first differing byte
+bool verifyPassword(const PasswordHash &h, string_view password) {
+    uint8_t d[32];
+    pbkdf2Sha256(password, h.salt, sizeof h.salt, h.iterations, d);
+    uint8_t diff = 0;
+    for (int i = 0; i < 32; ++i) diff |= d[i] ^ h.digest[i];
+    return diff == 0;
+}
+
+// logins are verified on a fixed set of threads, so a burst queues up instead of
+// running one key derivation per connection or session thread at once
+WorkerPool &hashPool() {
+    static WorkerPool pool(hardwareThreads());
+    return pool;
+}
+
+bool verifyOnPool(const PasswordHash &h, const string &password) {
+    auto done = make_shared<promise<bool>>();
+    future<bool> result = done->get_future();
+    hashPool().submit([h, password, done] { done->set_value(verifyPassword(h, password)); });
+    return result.get();
+}
+
+/*
+  Recently verified logins, least recently used dropped first. An entry is an HMAC,
+  under a key drawn at start-up and never stored, of the stored digest and the
+  password that matched it: a repeat login costs one HMAC instead of a key
+  derivation, the cache holds nothing that verifies a password outside this process,
+  and a password change invalidates the entry by changing the digest.
+*/
+class VerifyCache {
+public:
+    explicit VerifyCache(size_t capacity) : capacity(capacity), hmac(randomKey()) {}
+    bool hit(long long key, const PasswordHash &h, string_view password) {
+        uint8_t t[32];
+        tag(h, password, t);
+        lock_guard<mutex> lk(m);
+        auto it = entries.find(key);
+        if (it == entries.end() || memcmp(it->second.tag, t, 32) != 0) return false;
+        order.splice(order.begin(), order, it->second.age);
+        return true;
+    }
+    void put(long long key, const PasswordHash &h, string_view password) {
+        Entry e;
+        tag(h, password, e.tag);
+        lock_guard<mutex> lk(m);
+        auto it = entries.find(key);
+        if (it != entries.end()) { order.erase(it->second.age); entries.erase(it); }
+        if (entries.size() >= capacity) { entries.erase(order.back()); order.pop_back(); }
+        order.push_front(key);
+        e.age = order.begin();
+        entries.emplace(key, e);
+    }
+    void erase(long long key) {
+        lock_guard<mutex> lk(m);
+        auto it = entries.find(key);
+        if (it != entries.end()) { order.erase(it->second.age); entries.erase(it); }
+    }
+    void clear() { lock_guard<mutex> lk(m); entries.clear(); order.clear(); }
+private:
+    struct Entry { uint8_t tag[32]; list<long long>::iterator age; };
+    static string randomKey() { uint8_t k[32]; fillRandom(k, 32); return string((const char *)k, 32); }
+    void tag(const PasswordHash &h, string_view password, uint8_t *out) const {
+        string msg((const char *)h.digest, 32);
+        msg += password;
+        hmac.mac(msg.data(), msg.size(), out);
+    }
+    size_t capacity;
+    HmacSha256 hmac;
+    mutex m;
+    list<long long> order; // most recent first
+    unordered_map<long long, Entry> entries;
+};
+
+const size_t VERIFY_CACHE_ENTRIES = 4096;
+VerifyCache verifyCache(VERIFY_CACHE_ENTRIES);
+
+// -------------------- Credential store --------------------
+// role is 'S' (student) or 'P' (parent), same as generatePassword's type
+const string STUDENT_LOGIN_FILE = "student_login.txt";
+const string PARENT_LOGIN_FILE = "parent_login.txt";
+const string ADMIN_LOGIN_FILE = "admin_login.txt";
+
+// (role, roll) -> password hash, loaded once by loadCredentials()
+unordered_map<long long, PasswordHash> credentials;
+// guards credentials, the pending login lines and the login files
+shared_mutex credentialMutex;
+// lines currently in each login file, to decide when to compact it
+size_t studentLoginLines = 0, parentLoginLines = 0;
+
+long long credentialKey(char role, int roll) { return ((long long)role << 32) | (unsigned int)roll; }
+const string &credentialFile(char role) { return role == 'S' ? STUDENT_LOGIN_FILE : PARENT_LOGIN_FILE; }
+size_t &credentialLines(char role) { return role == 'S' ? studentLoginLines : parentLoginLines; }
+
+// rewrite one login file with only its live entries; false if it could not be written
+bool compactCredentialFile(char role) {
+    vector<pair<int,const PasswordHash *>> live;
+    for (auto &kv : credentials)
+        if ((char)(kv.first >> 32) == role) live.push_back({(int)(kv.first & 0xffffffff), &kv.second});
+    sort(live.begin(), live.end(), [](auto &a, auto &b) { return a.first < b.first; });
+    string out;
+    for (auto &e : live) out += to_string(e.first) + "|" + encodePasswordHash(*e.second) + "\n";
+    if (!writeFileAtomic(credentialFile(role), out)) return false;
+    credentialLines(role) = live.size();
+    return true;
+}
+
+// passOut is the stored field: a hash, or plaintext not yet migrated
+bool readAdminCredentials(string &userOut, string &passOut) {
+    MappedFile f(ADMIN_LOGIN_FILE);
+    if (!f.isOpen()) return false;
+    istringstream in{string(f.view())};
+    string u, p;
+    if (!(in >> u >> p)) return false;
+    userOut = u; passOut = p;
+    return true;
+}
+
+bool writeAdminCredentials(const string &user, const string &password) {
+    return writeFileAtomic(ADMIN_LOGIN_FILE, user + " " + encodePasswordHash(hashPassword(password)) + "\n");
+}
+
+// rewrites a plaintext admin_login.txt with a hash
+void migrateAdminPassword() {
+    string user, pass;
+    if (!readAdminCredentials(user, pass) || isPasswordHash(pass)) return;
+    if (!writeAdminCredentials(user, pass)) cout << "⚠ Could not hash the password in " << ADMIN_LOGIN_FILE << ".\n";
+}
+
+bool checkAdminPassword(const string &password) {
+    string user, pass;
+    PasswordHash h;
+    if (!readAdminCredentials(user, pass)) return false;
+    if (!decodePasswordHash(pass, h)) return !isPasswordHash(pass) && pass == password;
+    long long key = credentialKey('A', 0);
+    if (verifyCache.hit(key, h, password)) return true;
+    if (!verifyOnPool(h, password)) return false;
+    verifyCache.put(key, h, password);
+    return true;
+}
+
+// plaintext passwords found by the loader, hashed by migratePlaintextPasswords();
+// a key is in credentials or here, whichever its last line was
+unordered_map<long long, string> plaintextPasswords;
+
+void loadCredentialFile(char role) {
+    size_t &lines = credentialLines(role);
+    lines = 0;
+    MappedFile f(credentialFile(role));
+    if (!f.isOpen()) return;
+    string data(f.view());
+    istringstream in(data);
+    string line;
+    while (getline(in, line)) {
+        line = trim(line);
+        if (line.empty()) continue;
+        vector<string> p = split(line, '|');
+        if (p.size() != 2) continue;
+        string rstr = trim(p[0]);
+        if (!isDigits(rstr)) continue;
+        ++lines;
+        long long key = credentialKey(role, stoi(rstr));
+        string pw = trim(p[1]);
+        PasswordHash h;
+        if (pw.empty()) { credentials.erase(key); plaintextPasswords.erase(key); }
+        else if (decodePasswordHash(pw, h)) { credentials[key] = h; plaintextPasswords.erase(key); }
+        else if (!isPasswordHash(pw)) { credentials.erase(key); plaintextPasswords[key] = pw; }
+    }
+    // appends must start on a fresh line
+    if (!data.empty() && data.back() != '\n' && !compactCredentialFile(role))
+        cout << "⚠ Could not rewrite " << credentialFile(role) << ".\n";
+}
+
+// plaintext entries from older versions are hashed in parallel, then each login file
+// that had any is rewritten with hashes only
+void migratePlaintextPasswords() {
+    if (plaintextPasswords.empty()) return;
+    cout << "Hashing " << plaintextPasswords.size() << " plaintext passwords...\n";
+    vector<pair<long long, string>> pending(plaintextPasswords.begin(), plaintextPasswords.end());
+    vector<PasswordHash> hashed(pending.size());
+    parallelForStealing(hashed.size(), hardwareThreads(), [&](size_t i) { hashed[i] = hashPassword(pending[i].second); });
+    bool roles[2] = {false, false};
+    for (size_t i = 0; i < hashed.size(); ++i) {
+        credentials[pending[i].first] = hashed[i];
+        roles[(char)(pending[i].first >> 32) == 'P'] = true;
+    }
+    // plaintext left on disk is hashed again at the next start
+    for (char role : {'S', 'P'})
+        if (roles[role == 'P'] && !compactCredentialFile(role)) cout << "⚠ Could not rewrite " << credentialFile(role) << " with hashes.\n";
+    plaintextPasswords.clear();
+}
+
+void loadCredentials() {
+    MetricTimer timer(OP_LOAD_CREDENTIALS);
+    credentials.clear();
+    plaintextPasswords.clear();
+    verifyCache.clear();
+    loadCredentialFile('S');
+    loadCredentialFile('P');
+    migratePlaintextPasswords();
+    migrateAdminPassword();
+}
+
+// login lines queued while deferPersist is set
+string pendingStudentLogins, pendingParentLogins;
+
+// append roll|password lines; the file is compacted once dead lines dominate.
+// false if the lines could not be written
+bool appendCredentialLines(char role, const string &lines, size_t count) {
+    if (deferPersist) { (role == 'S' ? pendingStudentLogins : pendingParentLogins) += lines; return true; }
+    size_t &total = credentialLines(role);
+    if (!writeDurable(credentialFile(role), lines, true)) return false;
+    total += count;
+    // the lines are already safe; a failed compaction is retried on the next append
+    if (total > 2 * credentials.size() + 64 && !compactCredentialFile(role))
+        cout << "⚠ Could not compact " << credentialFile(role) << ".\n";
+    return true;
+}
+
+// stored is an encoded hash, or empty to remove the entry
+bool appendCredential(char role, int roll, const string &stored) {
+    return appendCredentialLines(role, to_string(roll) + "|" + stored + "\n", 1);
+}
+
+// the key derivation runs on hashPool() without credentialMutex held
+bool checkCredential(char role, int roll, const string &password) {
+    MetricTimer timer(OP_LOGIN);
+    long long key = credentialKey(role, roll);
+    PasswordHash h;
+    {
+        shared_lock<shared_mutex> lk(credentialMutex);
+        auto it = credentials.find(key);
+        if (it == credentials.end()) return false;
+        h = it->second;
+    }
+    if (verifyCache.hit(key, h, password)) return true;
+    if (!verifyOnPool(h, password)) return false;
+    verifyCache.put(key, h, password);
+    return true;
+}
+
+// caller holds credentialMutex; memory changes only once the login file has the line
+bool putCredential(char role, int roll, const PasswordHash &h) {
+    if (!appendCredential(role, roll, encodePasswordHash(h))) return false;
+    long long key = credentialKey(role, roll);
+    credentials[key] = h;
+    verifyCache.erase(key);
+    return true;
+}
+
+// caller holds credentialMutex
+bool dropCredential(char role, int roll) {
+    long long key = credentialKey(role, roll);
+    if (!credentials.count(key)) return true;
+    if (!appendCredential(role, roll, "")) return false;
+    credentials.erase(key);
+    verifyCache.erase(key);
+    return true;
+}
+
+// false if the new password could not be saved; the old one then still applies
+bool setCredential(char role, int roll, const string &password) {
+    MetricTimer timer(OP_CHANGE_PASSWORD);
+    PasswordHash h = hashPassword(password);
+    unique_lock<shared_mutex> lk(credentialMutex);
+    return putCredential(role, roll, h);
+}
+
+// hashed in parallel; call without any lock held
+vector<PasswordHash> hashPasswords(const vector<pair<int,string>> &entries) {
+    vector<PasswordHash> hashed(entries.size());
+    parallelForStealing(entries.size(), hardwareThreads(), [&](size_t i) { hashed[i] = hashPassword(entries[i].second); });
+    return hashed;
+}
+
+// caller holds credentialMutex; one append to the login file for all entries, then
+// memory. An empty hashed list removes the entries instead
+bool putCredentials(char role, const vector<pair<int,string>> &entries, const vector<PasswordHash> &hashed) {
+    if (entries.empty()) return true;
+    string out;
+    for (size_t i = 0; i < entries.size(); ++i)
+        out += to_string(entries[i].first) + "|" + (hashed.empty() ? "" : encodePasswordHash(hashed[i])) + "\n";
+    if (!appendCredentialLines(role, out, entries.size())) return false;
+    for (size_t i = 0; i < entries.size(); ++i) {
+        long long key = credentialKey(role, entries[i].first);
+        if (hashed.empty()) credentials.erase(key);
+        else credentials[key] = hashed[i];
+        verifyCache.erase(key);
+    }
+    return true;
+}
+
+void removeCredential(char role, int roll) {
+    unique_lock<shared_mutex> lk(credentialMutex);
+    dropCredential(role, roll);
+}
+
+// writes everything queued while deferPersist was set
+void flushPersistence() {
+    unique_lock<shared_mutex> storeLock(storeMutex);
+    unique_lock<shared_mutex> credLock(credentialMutex);
+    deferPersist = false;
+    string pending[2] = {std::move(pendingStudentLogins), std::move(pendingParentLogins)};
+    pendingStudentLogins.clear(); pendingParentLogins.clear();
+    for (int i = 0; i < 2; ++i) {
+        char role = i == 0 ? 'S' : 'P';
+        if (!pending[i].empty() && !appendCredentialLines(role, pending[i], count(pending[i].begin(), pending[i].end(), '\n')))
+            cout << "❌ Could not write " << credentialFile(role) << "; logins changed in this batch are lost on restart.\n";
+    }
+    if (rosterDirty) compactJournal();
+    rosterDirty = false;
+    unique_lock<shared_mutex> ticketLock(ticketMutex);
+    if (!pendingTicketRecords.empty() && !writeDurable(COMPLAINT_LOG, pendingTicketRecords, true))
+        cout << "⚠ Could not write " << COMPLAINT_LOG << ".\n";
+    pendingTicketRecords.clear();
+}
+
+// -------------------- Login helpers --------------------
+bool adminLogin() {
+    string u, p;
+    cout << "\nEnter Admin Username: ";
+    cin >> u;
+    cout << "Enter Password: ";
+    cin >> p;
+    MetricTimer timer(OP_LOGIN);
+    string user, pass;
+    if (!readAdminCredentials(user, pass)) {
+        cout << "⚠ admin_login.txt missing or malformed.\n";
+        return false;
+    }
+    return u == user && checkAdminPassword(p);
+}
+
+bool studentLogin(int &rollOut) {
+    string rollStr, pass;
+    cout << "Enter Roll Number: ";
+    cin >> rollStr;
+    while (!isDigits(rollStr)) {
+        cout << "❌ Invalid roll! Enter numbers only: ";
+        cin >> rollStr;
+    }
+    int roll = stoi(rollStr);
+    cout << "Enter Password: ";
+    cin >> pass;
+    if (checkCredential('S', roll, pass)) {
+        rollOut = roll; return true;
+    }
+    return false;
+}
+
+bool parentLogin(int &rollOut) {
+    string rollStr, pass;
+    cout << "Enter Student Roll Number: ";
+    cin >> rollStr;
+    while (!isDigits(rollStr)) {
+        cout << "❌ Invalid roll! Enter numbers only: ";
+        cin >> rollStr;
+    }
+    int roll = stoi(rollStr);
+    cout << "Enter Parent Password: ";
+    cin >> pass;
+    if (checkCredential('P', roll, pass)) {
+        rollOut = roll; return true;
+    }
+    return false;
+}
+
+// -------------------- Password change --------------------
+// For student/parent logins held in the credential store
+bool changePassword(char role, int roll) {
+    string oldPass; cout << "Enter old password: "; cin >> oldPass;
+    if (!checkCredential(role, roll, oldPass)) { cout<<"❌ Old password incorrect!\n"; return false; }
+
+    string newPass; cout << "Enter new password (min 6 chars): "; cin >> newPass;
+    while (newPass.length() < 6) { cout << "❌ Too short! Enter again: "; cin >> newPass; }
+    if (!setCredential(role, roll, newPass)) { cout << "❌ Could not save the new password; the old one still applies.\n"; return false; }
+    cout << "✔ Password changed successfully!\n";
+    return true;
+}
+
+// Admin password change (admin_login.txt format: username passwordHash)
+bool changeAdminPassword() {
+    string user, pass;
+    if (!readAdminCredentials(user, pass)) { cout << "⚠ admin_login.txt missing or malformed.\n"; return false; }
+    string oldP; cout << "Enter old admin password: "; cin >> oldP;
+    if (!checkAdminPassword(oldP)) { cout << "❌ Old password incorrect!\n"; return false; }
+    string newP; cout << "Enter new admin password (min 6 chars): "; cin >> newP;
+    while (newP.length() < 6) { cout << "❌ Too short! Enter again: "; cin >> newP; }
+    MetricTimer timer(OP_CHANGE_ADMIN_PASSWORD);
+    verifyCache.erase(credentialKey('A', 0));
+    if (!writeAdminCredentials(user, newP)) {
+        cout << "❌ Could not write admin_login.txt.\n"; return false;
+    }
+    cout << "✔ Admin password changed successfully!\n";
+    return true;
+}
+
+// -------------------- Paged listing --------------------
+/*
+  Keyset pagination: a page is the pageSize rows whose (sort key, roll) comes
+  right after the last row of the previous page (or right before the first, going
+  back). Each page re-reads the live store under a shared lock in O(n log pageSize),
+  so students added or removed while paging are never skipped or repeated.
+  Every page is formatted into one buffer and written with a single call.
+*/
+enum SortKey { SORT_ROLL, SORT_NAME, SORT_TOTAL, SORT_SUBJECT };  // SORT_SUBJECT + i sorts by subject i
+
+struct PageKey {
+    double num = 0;
+    string text;
+    int roll = 0;
+    bool operator<(const PageKey &o) const {
+        if (num != o.num) return num < o.num;
+        if (text != o.text) return text < o.text;
+        return roll < o.roll;
+    }
+};
+
+struct ListQuery {
+    int sort = SORT_ROLL;
+    string filter;              // case-insensitive substring of name or parent name; empty = all
+    size_t pageSize = 20;
+};
+
+bool stdoutIsTerminal() {
+#ifdef _WIN32
+    return _isatty(_fileno(stdout));
+#else
+    return isatty(STDOUT_FILENO);
+#endif
+}
+
+void writeOut(const string &buf) {
+    cout.write(buf.data(), (streamsize)buf.size());
+    cout.flush();
+}
+
+// totals and marks sort highest first
+PageKey pageKey(int roll, string_view name, const float *marks, int sort) {
+    PageKey k;
+    k.roll = roll;
+    if (sort == SORT_NAME) k.text = lowerCase(name);
+    else if (sort == SORT_TOTAL) { for (int i = 0; i < numSubjects; ++i) k.num -= marks[i]; }
+    else if (sort >= SORT_SUBJECT) k.num = -marks[sort - SORT_SUBJECT];
+    else k.num = roll;
+    return k;
+}
+
+PageKey pageKey(const Student &st, int sort) { return pageKey(st.roll, st.name, st.marks, sort); }
+
+// caller holds storeMutex
+PageKey storedPageKey(size_t pos, int sort) {
+    float marks[MAX_SUBJECTS];
+    marksAt(pos, marks);
+    return pageKey(students[pos].roll, nameOf(students[pos]), marks, sort);
+}
+
+bool containsIgnoreCase(string_view hay, const string &lowerNeedle) {
+    return search(hay.begin(), hay.end(), lowerNeedle.begin(), lowerNeedle.end(),
+                  [](char a, char b) { return tolower((unsigned char)a) == b; }) != hay.end();
+}
+
+bool matchesQuery(const StudentRecord &r, const ListQuery &q) {
+    return q.filter.empty() || containsIgnoreCase(nameOf(r), q.filter) || containsIgnoreCase(parentNameOf(r), q.filter);
+}
+
+// up to pageSize matching rows after `cursor` (before it when backward), in sort order
+vector<Student> fetchPage(const ListQuery &q, const PageKey *cursor, bool backward) {
+    shared_lock<shared_mutex> lk(storeMutex);
+    // heap top is the row that drops out first when the page is full
+    auto cmp = [backward](const pair<PageKey, size_t> &a, const pair<PageKey, size_t> &b) {
+        return backward ? b.first < a.first : a.first < b.first;
+    };
+    vector<pair<PageKey, size_t>> heap;
+    heap.reserve(q.pageSize + 1);
+    for (size_t i = 0; i < students.size(); ++i) {
+        if (!matchesQuery(students[i], q)) continue;
+        PageKey k = storedPageKey(i, q.sort);
+        if (cursor && (backward ? !(k < *cursor) : !(*cursor < k))) continue;
+        if (heap.size() == q.pageSize && !cmp({k, i}, heap.front())) continue;
+        heap.emplace_back(std::move(k), i);
+        push_heap(heap.begin(), heap.end(), cmp);
+        if (heap.size() > q.pageSize) { pop_heap(heap.begin(), heap.end(), cmp); heap.pop_back(); }
+    }
+    sort(heap.begin(), heap.end(), [](auto &a, auto &b) { return a.first < b.first; });
+    vector<Student> page;
+    page.reserve(heap.size());
+    for (auto &h : heap) page.push_back(studentAt(h.second));
+    return page;
+}
+
+void appendStudentRow(string &out, int roll, string_view name, string_view parentName, string_view mobile, const float *marks) {
+    out += to_string(roll);
+    out += " | "; out += name;
+    out += " | "; out += parentName;
+    out += " | "; out += mobile;
+    out += " | Marks:";
+    for (int i = 0; i < numSubjects; ++i) { out += i == 0 ? ' ' : ','; appendFloat(out, marks[i]); }
+    out += '\n';
+}
+
+void appendStudentRow(string &out, const Student &st) {
+    appendStudentRow(out, st.roll, st.name, st.parentName, st.parentMobile, st.marks);
+}
+
+// whole list in storage order, 1 MiB per write; used when stdout is not a terminal
+void dumpRows() {
+    shared_lock<shared_mutex> lk(storeMutex);
+    string buf;
+    buf.reserve(1 << 20);
+    char mobile[16];
+    float marks[MAX_SUBJECTS];
+    for (size_t pos = 0; pos < students.size(); ++pos) {
+        const StudentRecord &r = students[pos];
+        marksAt(pos, marks);
+        appendStudentRow(buf, r.roll, nameOf(r), parentNameOf(r), mobileView(r.mobile, mobile), marks);
+        if (buf.size() >= (1 << 20) - 4096) { cout.write(buf.data(), (streamsize)buf.size()); buf.clear(); }
+    }
+    writeOut(buf);
+}
+
+size_t promptPageSize() {
+    cout << "Rows per page (0 for 20): ";
+    long long n; if (!(cin >> n)) { cin.clear(); n = 0; }
+    return n > 0 ? (size_t)min(n, 100000LL) : 20;
+}
+
+void promptListQuery(ListQuery &q) {
+    cout << "Sort by: 1. Roll  2. Name  3. Total marks";
+    for (int i = 0; i < numSubjects; ++i) cout << "  " << i + 4 << ". " << subjectNames[i];
+    cout << "\nChoose: ";
+    int s; if (!(cin >> s)) { cin.clear(); s = 1; }
+    q.sort = s == 2 ? SORT_NAME : s == 3 ? SORT_TOTAL : s >= 4 && s < 4 + numSubjects ? SORT_SUBJECT + s - 4 : SORT_ROLL;
+    string f; cout << "Filter by name or parent name (- for none): "; cin >> f;
+    q.filter = f == "-" ? "" : lowerCase(f);
+    q.pageSize = promptPageSize();
+}
+
+// interactive pager; returns false if nothing matched
+bool pageThrough(const ListQuery &q, const string &title) {
+    vector<Student> page = fetchPage(q, nullptr, false);
+    if (page.empty()) return false;
+    size_t pageNo = 1;
+    string out;
+    while (true) {
+        if (out.empty()) {
+            out = "\n---- " + title + " (page " + to_string(pageNo) + ") ----\n";
+            for (auto &st : page) appendStudentRow(out, st);
+        }
+        out += "[n]ext  [p]revious  [q]uit: ";
+        writeOut(out);
+        out.clear();
+        string cmd; if (!(cin >> cmd) || cmd == "q") return true;
+        if (cmd != "n" && cmd != "p") { out = "Unknown choice.\n"; continue; }
+        if (cmd == "p" && pageNo == 1) { out = "First page.\n"; continue; }
+        PageKey cursor = pageKey(cmd == "n" ? page.back() : page.front(), q.sort);
+        vector<Student> next = fetchPage(q, &cursor, cmd == "p");
+        if (next.empty()) { out = cmd == "n" ? "Last page.\n" : "First page.\n"; continue; }
+        pageNo += cmd == "n" ? 1 : -1;
+        page = std::move(next);
+    }
+}
+
+// -------------------- Student management --------------------
+// the functions below lock storeMutex themselves and are safe to call from any thread
+bool rollExists(int roll) {
+    shared_lock<shared_mutex> lk(storeMutex);
+    return rollIndex.count(roll) != 0;
+}
+
+// copies the record out so callers never hold a reference into the store
+bool getStudent(int roll, Student &out) {
+    MetricTimer timer(OP_LOOKUP);
+    shared_lock<shared_mutex> lk(storeMutex);
+    size_t pos = findPos(roll);
+    if (pos == NO_POS) return false;
+    out = studentAt(pos);
+    return true;
+}
+
+// the first rank query builds the rank index
+void ensureRankIndex() {
+    { shared_lock<shared_mutex> lk(storeMutex); if (rankIndexBuilt) return; }
+    unique_lock<shared_mutex> lk(storeMutex);
+    if (!rankIndexBuilt) buildRankIndex();
+}
+
+// overall and per-subject rank of one student; false if the roll is gone
+bool studentRanks(int roll, Rank *subjects, Rank &total) {
+    ensureRankIndex();
+    shared_lock<shared_mutex> lk(storeMutex);
+    size_t pos = findPos(roll);
+    if (pos == NO_POS) return false;
+    for (int i = 0; i < numSubjects; ++i) subjects[i] = rankIn(subjectRanks[i], scoreBucket(markColumns[i][pos], SUBJECT_BUCKETS));
+    total = rankIn(totalRanks, scoreBucket(rowTotal(pos), totalBuckets()));
+    return true;
+}
+
+// sets subjects [first, last) from marks; false if the roll is gone
+bool updateStudentMarks(int roll, int first, int last, const float *marks) {
+    MetricTimer timer(OP_UPDATE_MARKS);
+    unique_lock<shared_mutex> lk(storeMutex);
+    size_t pos = findPos(roll);
+    if (pos == NO_POS) return false;
+    for (int i = first; i < last; ++i) setMark(pos, i, marks[i]);
+    persistStudent(studentAt(pos));
+    return true;
+}
+
+void compactDataFiles() {
+    MetricTimer timer(OP_COMPACT);
+    unique_lock<shared_mutex> lk(storeMutex);
+    compactJournal();
+}
+
+// addStudent() input rules; empty string when the fields are valid
+string validateStudentFields(const Student &st) {
+    if (!isAlphaOrSpace(st.name)) return "name: only alphabets and spaces allowed";
+    if (!isAlphaOrSpace(st.parentName)) return "parent name: only alphabets and spaces allowed";
+    if (!isDigits(st.parentMobile) || st.parentMobile.length() < 7 || st.parentMobile.length() > 15)
+        return "mobile must be 7-15 digits";
+    int bad = invalidMark(st.marks);
+    if (bad >= 0) return subjectNames[bad] + " marks must be 0-100";
+    return "";
+}
+
+// stores a validated student and generates both passwords; "" or the reason it failed.
+// The passwords are hashed before any lock is taken; the record and both logins then
+// change under storeMutex and credentialMutex together (the order flushPersistence
+// uses), so a concurrent delete of the roll sees all of them or none.
+string addStudentRecord(const Student &st, string &sPass, string &pPass) {
+    MetricTimer timer(OP_ADD_STUDENT);
+    sPass = initialPassword(st.name, 'S');
+    pPass = initialPassword(st.parentName, 'P');
+    PasswordHash sHash = hashPassword(sPass), pHash = hashPassword(pPass);
+    unique_lock<shared_mutex> storeLock(storeMutex);
+    unique_lock<shared_mutex> credLock(credentialMutex);
+    if (findPos(st.roll) != NO_POS) return "roll already exists";
+    // logins first: a student saved without them could never sign in
+    if (!putCredential('S', st.roll, sHash)) return "could not write " + credentialFile('S');
+    if (!putCredential('P', st.roll, pHash)) {
+        dropCredential('S', st.roll);
+        return "could not write " + credentialFile('P');
+    }
+    insertStudent(st);
+    persistStudent(st);
+    return "";
+}
+
+// removes the student and both logins together; false if not found
+bool deleteStudentRecord(int roll) {
+    MetricTimer timer(OP_DELETE_STUDENT);
+    {
+        unique_lock<shared_mutex> storeLock(storeMutex);
+        unique_lock<shared_mutex> credLock(credentialMutex);
+        if (!removeStudent(roll)) return false;
+        persistDelete(roll);
+        // the student is gone either way; a stale login line only matters if the roll is reused
+        if (!dropCredential('S', roll) || !dropCredential('P', roll))
+            cout << "⚠ Could not remove the logins of roll " << roll << " from the login files.\n";
+    }
+    resolveTicketsForRoll(roll);
+    return true;
+}
+
+void addStudent() {
+    Student st;
+    string rollStr;
+    cout << "\nEnter Roll Number (numbers only): ";
+    cin >> rollStr;
+    while (!isDigits(rollStr)) { cout << "❌ Invalid! Roll must contain numbers only. Re-enter: "; cin >> rollStr; }
+    st.roll = stoi(rollStr);
+    if (rollExists(st.roll)) { cout << "❌ Roll already exists. Aborting add.\n"; return; }
+    cin.ignore();
+
+    cout << "Enter Student Full Name: ";
+    getline(cin, st.name);
+    while (!isAlphaOrSpace(st.name)) { cout << "❌ Only alphabets and spaces allowed. Re-enter name: "; getline(cin, st.name); }
+
+    cout << "Enter Parent Full Name: ";
+    getline(cin, st.parentName);
+    while (!isAlphaOrSpace(st.parentName)) { cout << "❌ Only alphabets and spaces allowed. Re-enter parent name: "; getline(cin, st.parentName); }
+
+    cout << "Enter Parent Mobile (digits only, e.g. 10 digits): ";
+    string mob; cin >> mob;
+    while (!isDigits(mob) || mob.length() < 7 || mob.length() > 15) {
+        cout << "❌ Invalid mobile. Enter digits only (7-15 digits): "; cin >> mob;
+    }
+    st.parentMobile = mob;
+
+    cout << "Enter marks for subjects (0-100):\n";
+    for (int i = 0; i < numSubjects; ++i) {
+        float m; cout << subjectNames[i] << ": "; cin >> m;
+        while (m < 0 || m > 100) { cout << "❌ Invalid marks! Enter again (0-100): "; cin >> m; }
+        st.marks[i] = m;
+    }
+    cin.ignore();
+
+    string sPass, pPass;
+    string err = addStudentRecord(st, sPass, pPass);
+    if (!err.empty()) { cout << "❌ Could not add the student: " << err << ".\n"; return; }
+
+    cout << "\n✔ Student added successfully!\n";
+    cout << "Student Password: " << sPass << "\n";
+    cout << "Parent  Password: " << pPass << "\n";
+}
+
+// ranks and total are the student's ranks, as read with the marks
+void printStudentSummary(const Student &st, const Rank *ranks, const Rank &total) {
+    cout << "Roll: " << st.roll << "\n";
+    cout << "Name: " << st.name << "\n";
+    cout << "Parent: " << st.parentName << "\n";
+    cout << "Parent Mobile: " << (st.parentMobile.empty() ? "N/A" : st.parentMobile) << "\n";
+    auto printRank = [](const Rank &r) {
+        cout << "   (rank " << r.rank << " of " << r.classSize << ", percentile " << fixed << setprecision(1) << r.percentile << ")";
+        cout.unsetf(ios::floatfield);
+        cout << setprecision(6);
+    };
+    cout << "Marks:\n";
+    float sum = 0;
+    for (int i = 0; i < numSubjects; ++i) {
+        cout << "  " << subjectNames[i] << " : " << st.marks[i];
+        printRank(ranks[i]);
+        cout << "\n";
+        sum += st.marks[i];
+    }
+    cout << "  Total : " << sum;
+    printRank(total);
+    cout << "\n";
+    vector<Ticket> history = ticketsForRoll(st.roll);
+    if (history.empty()) { cout << "Complaints: None\n"; return; }
+    cout << "Complaints:\n";
+    for (auto &t : history) {
+        cout << "  #" << t.id << " [" << (t.isOpen() ? "open" : "resolved " + formatTime(t.resolvedAt)) << ", "
+             << PRIORITY_NAMES[t.priority] << "] " << formatTime(t.openedAt) << " " << t.text << "\n";
+    }
+}
+
+void viewStudents() {
+    MetricTimer timer(OP_VIEW_STUDENTS);
+    { shared_lock<shared_mutex> lk(storeMutex); if (students.empty()) { cout << "No students present.\n"; return; } }
+    if (!stdoutIsTerminal()) { cout << "\n---- STUDENT LIST ----\n"; dumpRows(); return; }
+    ListQuery q;
+    promptListQuery(q);
+    pageThrough(q, "STUDENT LIST");
+}
+
+void deleteStudent() {
+    string sRoll; cout << "Enter roll number to delete: "; cin >> sRoll;
+    if (!isDigits(sRoll)) { cout << "❌ Invalid roll input.\n"; return; }
+    int r = stoi(sRoll);
+    // also removes the student_login.txt and parent_login.txt entries;
+    // open complaint tickets of the roll are resolved; their history stays in complaints.log
+    if (!deleteStudentRecord(r)) { cout << "❌ Student not found.\n"; return; }
+    cout << "✔ Student deleted and related data removed.\n";
+}
+
+void updateMarks() {
+    string sRoll; cout << "Enter roll number: "; cin >> sRoll;
+    if (!isDigits(sRoll)) { cout << "❌ Invalid roll input.\n"; return; }
+    int r = stoi(sRoll);
+    if (!rollExists(r)) { cout << "❌ Student not found.\n"; return; }
+    cout << "Update marks options:\n1. Update all subjects\n2. Update single subject\nChoose: ";
+    int ch; cin >> ch;
+    float marks[MAX_SUBJECTS];
+    int first = 0, last = numSubjects;
+    if (ch == 1) {
+        for (int i = 0; i < numSubjects; ++i) {
+            float m; cout << subjectNames[i] << ": "; cin >> m;
+            while (m < 0 || m > 100) { cout << "❌ Invalid marks! Enter again (0-100): "; cin >> m; }
+            marks[i] = m;
+        }
+    } else {
+        for (int i = 0; i < numSubjects; ++i) cout << i+1 << ". " << subjectNames[i] << "\n";
+        cout << "Choose subject number: "; int si; cin >> si;
+        if (si < 1 || si > numSubjects) { cout << "❌ Invalid choice.\n"; return; }
+        float m; cout << "Enter marks for " << subjectNames[si-1] << ": "; cin >> m;
+        while (m < 0 || m > 100) { cout << "❌ Invalid marks! Enter again (0-100): "; cin >> m; }
+        first = si - 1; last = si;
+        marks[first] = m;
+    }
+    if (!updateStudentMarks(r, first, last, marks)) { cout << "❌ Student not found.\n"; return; }
+    cout << "✔ Marks updated.\n";
+}
+
+// -------------------- Published results --------------------
+/*
+  Student and parent views read a copy of the roster, not the live store. A copy
+  records the rosterVersion it was taken at and is shared through one atomic
+  shared_ptr, and it is never changed once shared. A reader that finds it current
+  takes no lock. loadAll() makes the first copy; a stale one is rebuilt by one
+  reader at a time under a shared lock, taking the rank trees from the live
+  index. While a writer holds the store or another reader is rebuilding, a reader
+  keeps the last complete copy instead of waiting, so a publish is seen all at
+  once or not at all.
+
+  Results day: marks are staged in results.draft without touching the roster.
+  Each line is roll|subject|mark, appended and fsync'd, and the last line for a
+  roll and subject wins. Publishing works in four steps:
+    1. rename results.draft to results.publish (the commit point)
+    2. apply every mark under one exclusive lock
+    3. write the roster once: students.txt or students.bin by write and rename,
+       or the touched shards
+    4. remove results.publish
+  A results.publish left by a crash is applied again at start-up. The marks are
+  absolute, so applying them twice is harmless.
+*/
+const string RESULTS_DRAFT_FILE = "results.draft";
+const string RESULTS_PUBLISH_FILE = "results.publish";
+
+// the roster by roll
+struct ResultsSnapshot {
+    struct Row {
+        int roll;
+        uint32_t text;                          // name, parent name and mobile, back to back
+        uint32_t nameLen, parentLen, mobileLen;
+    };
+    uint64_t version = 0; // rosterVersion it was copied at
+    int subjects = 0;
+    size_t totalBuckets = 0;
+    vector<Row> rows;
+    string text;
+    vector<float> marks; // row by row, `subjects` per row
+    vector<Fenwick> subjectRanks;
+    Fenwick totalRanks;
+
+    bool find(int roll, Student &st, Rank *ranks, Rank &total) const {
+        auto it = lower_bound(rows.begin(), rows.end(), roll, [](const Row &r, int v) { return r.roll < v; });
+        if (it == rows.end() || it->roll != roll) return false;
+        const char *p = text.data() + it->text;
+        st.roll = roll;
+        st.name.assign(p, it->nameLen); p += it->nameLen;
+        st.parentName.assign(p, it->parentLen); p += it->parentLen;
+        st.parentMobile.assign(p, it->mobileLen);
+        const float *m = marks.data() + (size_t)(it - rows.begin()) * subjects;
+        float sum = 0;
+        for (int i = 0; i < subjects; ++i) {
+            st.marks[i] = m[i];
+            sum += m[i];
+            ranks[i] = rankIn(subjectRanks[i], scoreBucket(m[i], SUBJECT_BUCKETS));
+        }
+        total = rankIn(totalRanks, scoreBucket(sum, totalBuckets));
+        return true;
+    }
+};
+
+// the last complete copy; read and replaced only with atomic_load / atomic_store
+shared_ptr<const ResultsSnapshot> publishedResults;
+
+// caller holds storeMutex; the live rank trees are copied when built, else built
+// from the copied marks as buildRankIndex() does for the live columns
+shared_ptr<const ResultsSnapshot> copyResults() {
+    auto snap = make_shared<ResultsSnapshot>();
+    snap->version = rosterVersion.load();
+    snap->subjects = numSubjects;
+    snap->totalBuckets = totalBuckets();
+    vector<size_t> order(students.size());
+    iota(order.begin(), order.end(), 0);
+    sort(order.begin(), order.end(), [](size_t a, size_t b) { return students[a].roll < students[b].roll; });
+    snap->rows.reserve(order.size());
+    snap->marks.resize(order.size() * numSubjects);
+    char buf[16];
+    float *m = snap->marks.data();
+    for (size_t pos : order) {
+        const StudentRecord &r = students[pos];
+        string_view name = nameOf(r), parent = parentNameOf(r), mobile = mobileView(r.mobile, buf);
+        snap->rows.push_back({r.roll, (uint32_t)snap->text.size(), (uint32_t)name.size(), (uint32_t)parent.size(), (uint32_t)mobile.size()});
+        snap->text.append(name).append(parent).append(mobile);
+        marksAt(pos, m);
+        m += numSubjects;
+    }
+    if (rankIndexBuilt) {
+        snap->subjectRanks.assign(subjectRanks.begin(), subjectRanks.begin() + numSubjects);
+        snap->totalRanks = totalRanks;
+        return snap;
+    }
+    vector<int> counts(SUBJECT_BUCKETS);
+    snap->subjectRanks.resize(numSubjects);
+    for (int i = 0; i < numSubjects; ++i) {
+        fill(counts.begin(), counts.end(), 0);
+        for (size_t row = 0; row < order.size(); ++row) ++counts[scoreBucket(snap->marks[row * numSubjects + i], SUBJECT_BUCKETS)];
+        snap->subjectRanks[i].assign(counts);
+    }
+    counts.assign(snap->totalBuckets, 0);
+    for (size_t row = 0; row < order.size(); ++row)
+        ++counts[scoreBucket(sumMarks(snap->marks.data() + row * numSubjects), snap->totalBuckets)];
+    snap->totalRanks.assign(counts);
+    return snap;
+}
+
+// one reader at a time rebuilds a stale copy; the others keep serving the last one
+mutex resultsRebuildMutex;
+
+// the copy, rebuilt first if the roster changed; while a writer holds the store or
+// another reader is rebuilding, the last complete copy is returned instead of waiting
+shared_ptr<const ResultsSnapshot> currentResults() {
+    shared_ptr<const ResultsSnapshot> snap = atomic_load(&publishedResults);
+    if (snap && snap->version == rosterVersion.load()) return snap;
+    unique_lock<mutex> rebuild(resultsRebuildMutex, try_to_lock);
+    if (!rebuild.owns_lock()) {
+        if (snap) return snap;
+        rebuild.lock(); // no copy yet
+    }
+    snap = atomic_load(&publishedResults); // the previous rebuilder may have just stored it
+    if (snap && snap->version == rosterVersion.load()) return snap;
+    shared_lock<shared_mutex> lk(storeMutex, try_to_lock);
+    if (!lk.owns_lock()) {
+        if (snap) return snap;
+        lk.lock(); // no copy yet; only before loadAll() has made the first one
+    }
+    // stored before the lock is released, so a newer copy is never overwritten by an older one
+    snap = copyResults();
+    atomic_store(&publishedResults, snap);
+    return snap;
+}
+
+// false if the roll is not in the published results
+bool publishedStudent(int roll, Student &st, Rank *ranks, Rank &total) {
+    MetricTimer timer(OP_LOOKUP);
+    return currentResults()->find(roll, st, ranks, total);
+}
+
+// (roll, subject) -> staged mark, in roll order; guarded by draftMutex with results.draft
+map<pair<int, string>, float> resultsDraft;
+// taken before storeMutex
+mutex draftMutex;
+
+struct StagedMark {
+    int roll;
+    string subject;
+    float mark;
+};
+
+// complete roll|subject|mark lines into draft; returns the end of the last complete line.
+// A mark outside 0-100 is skipped like a malformed line, as draft-marks would refuse it
+size_t parseResultsDraft(string_view data, map<pair<int, string>, float> &draft) {
+    size_t pos = 0, validEnd = 0;
+    while (true) {
+        size_t nl = data.find('\n', pos);
+        if (nl == string_view::npos) break; // unterminated tail = torn write, ignored
+        string_view rec = data.substr(pos, nl - pos);
+        pos = validEnd = nl + 1;
+        size_t a = rec.find('|'), b = rec.rfind('|');
+        int roll;
+        float mark;
+        if (a == b || !parseIntView(rec.substr(0, a), roll) || !parseFloatView(rec.substr(b + 1), mark)) continue;
+        if (!(mark >= 0 && mark <= 100)) continue;
+        draft[{roll, string(rec.substr(a + 1, b - a - 1))}] = mark;
+    }
+    return validEnd;
+}
+
+// applies staged marks, saves the roster and shares the new copy, all under one
+// exclusive lock. Rolls no longer on the roster, subjects no longer in the schema and
+// marks outside 0-100 are skipped. results.publish is removed once the roster is saved.
+void applyResults(const map<pair<int, string>, float> &draft, size_t &applied, size_t &skipped) {
+    MetricTimer timer(OP_PUBLISH_RESULTS);
+    unique_lock<shared_mutex> lk(storeMutex);
+    applied = skipped = 0;
+    for (auto &[key, mark] : draft) {
+        size_t pos = findPos(key.first);
+        auto it = find(subjectNames.begin(), subjectNames.end(), key.second);
+        if (pos == NO_POS || it == subjectNames.end() || !(mark >= 0 && mark <= 100)) { ++skipped; continue; }
+        setMark(pos, (int)(it - subjectNames.begin()), mark);
+        if (shardedRoster) markShardDirty(key.first);
+        ++applied;
+    }
+    if (compactJournal()) {
+        error_code ec;
+        filesystem::remove(RESULTS_PUBLISH_FILE, ec);
+    } else {
+        cout << "⚠ The roster could not be saved; " << RESULTS_PUBLISH_FILE << " is applied again at the next start.\n";
+    }
+    atomic_store(&publishedResults, copyResults());
+}
+
+// start-up: finishes a publish cut short by a crash, then reads the draft
+void loadResults() {
+    if (filesystem::exists(RESULTS_PUBLISH_FILE)) {
+        map<pair<int, string>, float> pending;
+        {
+            MappedFile in(RESULTS_PUBLISH_FILE);
+            parseResultsDraft(in.view(), pending);
+        }
+        size_t applied, skipped;
+        applyResults(pending, applied, skipped);
+        cout << "✔ Finished publishing " << applied << " mark(s) interrupted at the last run.\n";
+    }
+    lock_guard<mutex> lk(draftMutex);
+    resultsDraft.clear();
+    MappedFile in(RESULTS_DRAFT_FILE);
+    if (!in.isOpen()) return;
+    size_t validEnd = parseResultsDraft(in.view(), resultsDraft);
+    // cut the torn tail so later appends start on a clean line
+    if (validEnd < in.view().size()) {
+        error_code ec;
+        filesystem::resize_file(RESULTS_DRAFT_FILE, validEnd, ec);
+    }
+}
+
+// appends marks to the draft with one fsync'd write; on error err names the first bad
+// entry and nothing is staged
+bool stageMarks(const vector<StagedMark> &marks, string &err) {
+    MetricTimer timer(OP_STAGE_MARKS);
+    {
+        shared_lock<shared_mutex> lk(storeMutex);
+        for (auto &m : marks) {
+            if (findPos(m.roll) == NO_POS) { err = "roll " + to_string(m.roll) + " not found"; return false; }
+            if (find(subjectNames.begin(), subjectNames.end(), m.subject) == subjectNames.end()) { err = "unknown subject " + m.subject; return false; }
+            if (!(m.mark >= 0 && m.mark <= 100)) { err = "marks must be 0-100"; return false; }
+        }
+    }
+    string out;
+    out.reserve(marks.size() * 24);
+    for (auto &m : marks) {
+        out += to_string(m.roll);
+        out += '|'; out += m.subject;
+        out += '|'; appendFloat(out, m.mark);
+        out += '\n';
+    }
+    lock_guard<mutex> lk(draftMutex);
+    if (!writeDurable(RESULTS_DRAFT_FILE, out, true)) { err = "could not write " + RESULTS_DRAFT_FILE; return false; }
+    for (auto &m : marks) resultsDraft[{m.roll, m.subject}] = m.mark;
+    return true;
+}
+
+// publishes the whole draft; empty string on success
+string publishResults(size_t &applied, size_t &skipped) {
+    lock_guard<mutex> lk(draftMutex);
+    if (resultsDraft.empty()) return "the results draft is empty";
+    // the commit point: from here on the draft is published, even after a crash
+    error_code ec;
+    filesystem::rename(RESULTS_DRAFT_FILE, RESULTS_PUBLISH_FILE, ec);
+    if (ec) return "could not rename " + RESULTS_DRAFT_FILE + ": " + ec.message();
+    applyResults(resultsDraft, applied, skipped);
+    resultsDraft.clear();
+    return "";
+}
+
+// returns the number of marks dropped
+size_t discardResultsDraft() {
+    lock_guard<mutex> lk(draftMutex);
+    size_t n = resultsDraft.size();
+    resultsDraft.clear();
+    error_code ec;
+    filesystem::remove(RESULTS_DRAFT_FILE, ec);
+    return n;
+}
+
+map<pair<int, string>, float> stagedResults() {
+    lock_guard<mutex> lk(draftMutex);
+    return resultsDraft;
+}
+
+// students with lo <= roll <= hi, by roll
+vector<Student> studentsInRollRange(int lo, int hi) {
+    shared_lock<shared_mutex> lk(storeMutex);
+    vector<Student> out;
+    for (size_t pos = 0; pos < students.size(); ++pos)
+        if (students[pos].roll >= lo && students[pos].roll <= hi) out.push_back(studentAt(pos));
+    sort(out.begin(), out.end(), [](const Student &a, const Student &b) { return a.roll < b.roll; });
+    return out;
+}
+
+bool promptRollRange(int &lo, int &hi) {
+    string a, b;
+    cout << "From roll: "; cin >> a;
+    cout << "To roll: "; cin >> b;
+    if (!parseIntView(a, lo) || !parseIntView(b, hi) || lo > hi) { cout << "❌ Invalid roll range.\n"; return false; }
+    return true;
+}
+
+// 1 with the mark in m, 0 for "-" (skip), -1 for "q" (stop)
+int promptStagedMark(const string &prompt, float &m) {
+    while (true) {
+        cout << prompt;
+        string in;
+        if (!(cin >> in) || in == "q") return -1;
+        if (in == "-") return 0;
+        if (parseFloatView(in, m) && m >= 0 && m <= 100) return 1;
+        cout << "❌ Enter marks 0-100, - to skip or q to stop.\n";
+    }
+}
+
+string markText(float m) {
+    string s;
+    appendFloat(s, m);
+    return s;
+}
+
+// subject < 0: every subject of each student in a roll range, otherwise one subject;
+// each student's marks are staged as soon as they are typed
+void stageMarksPrompt(int subject) {
+    int lo, hi;
+    if (!promptRollRange(lo, hi)) return;
+    vector<Student> range = studentsInRollRange(lo, hi);
+    if (range.empty()) { cout << "No students in that range.\n"; return; }
+    cout << "Marks 0-100, - to skip, q to stop.\n";
+    size_t staged = 0;
+    bool stop = false;
+    for (auto &st : range) {
+        vector<StagedMark> marks;
+        int first = subject < 0 ? 0 : subject, last = subject < 0 ? numSubjects : subject + 1;
+        if (subject < 0) cout << st.roll << " " << st.name << "\n";
+        for (int s = first; s < last && !stop; ++s) {
+            string prompt = subject < 0 ? "  " + subjectNames[s] : to_string(st.roll) + " " + st.name;
+            float m;
+            int r = promptStagedMark(prompt + " (now " + markText(st.marks[s]) + "): ", m);
+            if (r < 0) stop = true;
+            else if (r > 0) marks.push_back({st.roll, subjectNames[s], m});
+        }
+        string err;
+        if (!marks.empty() && !stageMarks(marks, err)) cout << "❌ " << err << "\n";
+        else staged += marks.size();
+        if (stop) break;
+    }
+    cout << "✔ " << staged << " mark(s) staged. Students and parents see them once the draft is published.\n";
+}
+
+void reviewResultsDraft() {
+    auto draft = stagedResults();
+    if (draft.empty()) { cout << "The results draft is empty.\n"; return; }
+    string out = "\n---- RESULTS DRAFT (" + to_string(draft.size()) + " marks) ----\n";
+    Student st;
+    int lastRoll = -1;
+    bool found = false;
+    for (auto &[key, mark] : draft) {
+        if (key.first != lastRoll) { found = getStudent(key.first, st); lastRoll = key.first; }
+        auto it = find(subjectNames.begin(), subjectNames.end(), key.second);
+        out += to_string(key.first) + " " + (found ? st.name : "(not on the roster)") + " | " + key.second + ": ";
+        if (found && it != subjectNames.end()) out += markText(st.marks[it - subjectNames.begin()]) + " -> ";
+        out += markText(mark) + "\n";
+    }
+    writeOut(out);
+}
+
+void resultsMenu() {
+    cout << "Results draft: " << stagedResults().size() << " mark(s) staged.\n";
+    cout << "1. Enter Marks for a Subject\n2. Enter Marks for a Section\n3. Review Draft\n4. Publish Draft\n5. Discard Draft\nChoose: ";
+    int ch; cin >> ch;
+    if (ch == 1) {
+        for (int i = 0; i < numSubjects; ++i) cout << i + 1 << ". " << subjectNames[i] << "\n";
+        cout << "Choose subject number: "; int si; cin >> si;
+        if (si < 1 || si > numSubjects) { cout << "❌ Invalid choice.\n"; return; }
+        stageMarksPrompt(si - 1);
+    } else if (ch == 2) {
+        stageMarksPrompt(-1);
+    } else if (ch == 3) {
+        reviewResultsDraft();
+    } else if (ch == 4) {
+        cout << "Publish " << stagedResults().size() << " mark(s) to students and parents? (y/n): ";
+        string yn; cin >> yn;
+        if (yn != "y" && yn != "Y") { cout << "Not published.\n"; return; }
+        size_t applied, skipped;
+        string err = publishResults(applied, skipped);
+        if (!err.empty()) { cout << "❌ " << err << ".\n"; return; }
+        cout << "✔ Published " << applied << " mark(s).\n";
+        if (skipped) cout << "⚠ " << skipped << " mark(s) skipped: student deleted or subject removed.\n";
+    } else if (ch == 5) {
+        cout << "✔ Discarded " << discardResultsDraft() << " staged mark(s).\n";
+    } else {
+        cout << "❌ Invalid choice.\n";
+    }
+}
+
+// -------------------- Search --------------------
+// O(log n + matches) through the secondary indexes; the first search builds them
+void ensureSecondaryIndexes() {
+    { shared_lock<shared_mutex> lk(storeMutex); if (secondaryIndexesBuilt) return; }
+    unique_lock<shared_mutex> lk(storeMutex);
+    if (!secondaryIndexesBuilt) buildSecondaryIndexes();
+}
+
+// caller holds storeMutex
+void collectRolls(const vector<int> &rolls, vector<Student> &out) {
+    out.reserve(rolls.size());
+    for (int r : rolls) {
+        size_t pos = findPos(r);
+        if (pos != NO_POS) out.push_back(studentAt(pos));
+    }
+}
+
+// case-insensitive prefix match on the student name, or the parent name
+vector<Student> searchByNamePrefix(const string &prefix, bool parentName) {
+    MetricTimer timer(OP_SEARCH);
+    ensureSecondaryIndexes();
+    string key = lowerCase(prefix);
+    shared_lock<shared_mutex> lk(storeMutex);
+    auto &idx = parentName ? parentNameIndex : nameIndex;
+    vector<int> rolls;
+    for (auto it = idx.lower_bound({key, INT_MIN}); it != idx.end() && it->first.compare(0, key.size(), key) == 0; ++it)
+        rolls.push_back(it->second);
+    vector<Student> out;
+    collectRolls(rolls, out);
+    return out;
+}
+
+vector<Student> searchByMobile(const string &mobile) {
+    MetricTimer timer(OP_SEARCH);
+    ensureSecondaryIndexes();
+    shared_lock<shared_mutex> lk(storeMutex);
+    vector<int> rolls;
+    uint64_t packed;
+    if (!findPackedMobile(mobile, packed)) return {};
+    auto range = mobileIndex.equal_range(packed);
+    for (auto it = range.first; it != range.second; ++it) rolls.push_back(it->second);
+    sort(rolls.begin(), rolls.end());
+    vector<Student> out;
+    collectRolls(rolls, out);
+    return out;
+}
+
+// lo <= mark <= hi, lowest mark first
+vector<Student> searchByMarks(int subject, float lo, float hi) {
+    MetricTimer timer(OP_SEARCH);
+    ensureSecondaryIndexes();
+    shared_lock<shared_mutex> lk(storeMutex);
+    auto &idx = markIndex[subject];
+    vector<int> rolls;
+    for (auto it = idx.lower_bound({lo, INT_MIN}); it != idx.end() && it->first <= hi; ++it) rolls.push_back(it->second);
+    vector<Student> out;
+    collectRolls(rolls, out);
+    return out;
+}
+
+void searchStudents() {
+    cout << "Search by:\n1. Name prefix\n2. Parent name prefix\n3. Parent mobile\n4. Marks range\nChoose: ";
+    int ch; cin >> ch;
+    vector<Student> found;
+    if (ch == 1 || ch == 2) {
+        string prefix; cout << "Enter prefix: "; cin.ignore(); getline(cin, prefix);
+        found = searchByNamePrefix(trim(prefix), ch == 2);
+    } else if (ch == 3) {
+        string mob; cout << "Enter parent mobile: "; cin >> mob;
+        if (!isDigits(mob)) { cout << "❌ Mobile must be digits.\n"; return; }
+        found = searchByMobile(mob);
+    } else if (ch == 4) {
+        for (int i = 0; i < numSubjects; ++i) cout << i+1 << ". " << subjectNames[i] << "\n";
+        cout << "Choose subject number: "; int si; cin >> si;
+        if (si < 1 || si > numSubjects) { cout << "❌ Invalid choice.\n"; return; }
+        float lo, hi; cout << "Lowest mark: "; cin >> lo; cout << "Highest mark: "; cin >> hi;
+        if (!cin || lo > hi) { cin.clear(); cout << "❌ Invalid range.\n"; return; }
+        found = searchByMarks(si - 1, lo, hi);
+    } else { cout << "❌ Invalid choice.\n"; return; }
+    if (found.empty()) { cout << "No matching students.\n"; return; }
+    string out = "\n---- " + to_string(found.size()) + " MATCHING STUDENTS ----\n";
+    for (auto &st : found) appendStudentRow(out, st);
+    writeOut(out);
+}
+
+// -------------------- Bulk CSV --------------------
+// roll,name,parentName,parentMobile,<one column per subject>; a header row is optional,
+// but if present it must name the roster's subjects in order
+const int MAX_CSV_COLUMNS = 4 + MAX_SUBJECTS;
+
+// splits one CSV row in place; surrounding quotes are stripped, returns the field count
+int splitCsvRow(string_view line, string_view *out, int maxFields) {
+    int n = 0;
+    while (true) {
+        size_t comma = line.find(',');
+        string_view f = trimView(line.substr(0, comma));
+        if (f.size() >= 2 && f.front() == '"' && f.back() == '"') f = f.substr(1, f.size() - 2);
+        if (n < maxFields) out[n] = f;
+        ++n;
+        if (comma == string_view::npos) return n;
+        line.remove_prefix(comma + 1);
+    }
+}
+
+// same rules as addStudent(); empty string when the row is valid
+string validateCsvRow(const string_view *f, Student &st) {
+    string rollStr(f[0]);
+    if (!isDigits(rollStr)) return "roll must contain numbers only";
+    auto rr = from_chars(rollStr.data(), rollStr.data() + rollStr.size(), st.roll);
+    if (rr.ec != errc()) return "roll out of range";
+    if (findPos(st.roll) != NO_POS) return "roll already exists";
+    st.name.assign(f[1]);
+    st.parentName.assign(f[2]);
+    st.parentMobile.assign(f[3]);
+    for (int i = 0; i < numSubjects; ++i)
+        if (!parseFloatView(f[4 + i], st.marks[i])) return subjectNames[i] + " marks must be 0-100";
+    return validateStudentFields(st);
+}
+
+// streams the file and validates every row, hashes the new passwords without a
+// lock, then commits all valid rows and their logins at once under both locks
+bool importStudentsCsv(const string &filename) {
+    MetricTimer timer(OP_IMPORT_CSV);
+    MappedFile in(filename);
+    if (!in.isOpen()) { cout << "❌ Cannot open " << filename << ".\n"; return false; }
+    auto t0 = chrono::steady_clock::now();
+    string_view data = in.view();
+    if (data.compare(0, 3, "\xEF\xBB\xBF") == 0) data.remove_prefix(3); // UTF-8 BOM from spreadsheet exports
+    vector<Student> rows;
+    vector<size_t> rowLines;
+    unordered_set<int> rolls;
+    size_t lineNo = 0, rejected = 0;
+    const size_t MAX_REPORTED = 20;
+    const int columns = 4 + numSubjects;
+    string_view f[MAX_CSV_COLUMNS];
+    Student st;
+    bool firstRow = true, badHeader = false;
+    auto reject = [&](size_t line, const string &err) {
+        if (++rejected <= MAX_REPORTED) cout << "❌ line " << line << ": " << err << "\n";
+    };
+    {
+        shared_lock<shared_mutex> lk(storeMutex);
+        forEachLine(data, [&](string_view line) {
+            ++lineNo;
+            if (badHeader || trimView(line).empty()) return;
+            int n = splitCsvRow(line, f, MAX_CSV_COLUMNS);
+            if (firstRow && (firstRow = false, !isDigitsView(f[0]))) { // header
+                for (int i = 0; i < numSubjects; ++i) badHeader = badHeader || n != columns || f[4 + i] != subjectNames[i];
+                return;
+            }
+            string err = n != columns ? "expected " + to_string(columns) + " columns" : validateCsvRow(f, st);
+            if (err.empty() && !rolls.insert(st.roll).second) err = "roll already exists";
+            if (!err.empty()) { reject(lineNo, err); return; }
+            rows.push_back(st);
+            rowLines.push_back(lineNo);
+        });
+    }
+    if (badHeader) {
+        cout << "❌ The header of " << filename << " does not list the subjects " << joinSubjects(subjectNames) << ".\n";
+        return false;
+    }
+    vector<pair<int,string>> sLogins, pLogins;
+    for (auto &row : rows) {
+        sLogins.push_back({row.roll, initialPassword(row.name, 'S')});
+        pLogins.push_back({row.roll, initialPassword(row.parentName, 'P')});
+    }
+    vector<PasswordHash> sHashes = hashPasswords(sLogins), pHashes = hashPasswords(pLogins);
+    size_t added = 0;
+    {
+        // the same order as addStudentRecord: no reader sees a new student without its logins
+        unique_lock<shared_mutex> storeLock(storeMutex);
+        unique_lock<shared_mutex> credLock(credentialMutex);
+        for (size_t i = 0; i < rows.size(); ++i) {
+            if (!insertStudent(rows[i])) { reject(rowLines[i], "roll already exists"); continue; } // added meanwhile
+            if (shardedRoster) markShardDirty(rows[i].roll);
+            if (added != i) {
+                sLogins[added] = std::move(sLogins[i]); pLogins[added] = std::move(pLogins[i]);
+                sHashes[added] = sHashes[i]; pHashes[added] = pHashes[i];
+            }
+            ++added;
+        }
+        sLogins.resize(added); pLogins.resize(added); sHashes.resize(added); pHashes.resize(added);
+        if (added > 0) {
+            // logins first, then one snapshot write for the whole batch; on any failure the
+            // new rows (in memory only) and the logins already written are taken back
+            bool sSaved = putCredentials('S', sLogins, sHashes);
+            bool pSaved = sSaved && putCredentials('P', pLogins, pHashes);
+            const char *failed = !sSaved || !pSaved ? "the login files" : nullptr;
+            if (!failed && !deferPersist && !compactJournal()) failed = "the roster";
+            if (failed) {
+                for (auto &login : sLogins) removeStudent(login.first);
+                if (sSaved) putCredentials('S', sLogins, {});
+                if (pSaved) putCredentials('P', pLogins, {});
+                cout << "❌ Could not save " << failed << "; nothing was imported.\n";
+                return false;
+            }
+            if (deferPersist) rosterDirty = true;
+        }
+    }
+    if (rejected > MAX_REPORTED) cout << "... " << rejected - MAX_REPORTED << " more rejected rows\n";
+    if (added > 0) {
+        // the passwords are random and only their hashes are stored: this is the one copy
+        string pwFile = filename + ".passwords.csv", pw = "roll,studentPassword,parentPassword\n";
+        for (size_t i = 0; i < sLogins.size(); ++i)
+            pw += to_string(sLogins[i].first) + "," + sLogins[i].second + "," + pLogins[i].second + "\n";
+        if (writeFileAtomic(pwFile, pw)) cout << "✔ Initial passwords written to " << pwFile << ".\n";
+        else cout << "⚠ Could not write " << pwFile << "; reset the new accounts' passwords.\n";
+    }
+    double sec = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+    cout << "✔ Imported " << added << " students, rejected " << rejected << " rows in " << sec << " s";
+    if (sec > 0) cout << " (" << (size_t)(lineNo / sec) << " rows/s)";
+    cout << "\n";
+    return true;
+}
+
+bool exportStudentsCsv(const string &filename) {
+    MetricTimer timer(OP_EXPORT_CSV);
+    auto t0 = chrono::steady_clock::now();
+    ofstream out(filename, ios::binary);
+    if (!out) { cout << "❌ Cannot write " << filename << ".\n"; return false; }
+    shared_lock<shared_mutex> lk(storeMutex);
+    string buf = "roll,name,parentName,parentMobile";
+    for (auto &sub : subjectNames) buf += "," + sub;
+    buf += "\n";
+    size_t written = 0;
+    char mobile[16];
+    for (size_t pos = 0; pos < students.size(); ++pos) {
+        const StudentRecord &r = students[pos];
+        buf += to_string(r.roll);
+        buf += ','; buf += nameOf(r);
+        buf += ','; buf += parentNameOf(r);
+        buf += ','; buf += mobileView(r.mobile, mobile);
+        float marks[MAX_SUBJECTS];
+        marksAt(pos, marks);
+        buf += ',';
+        appendMarks(buf, marks);
+        buf += '\n';
+        if (buf.size() >= (1 << 20)) { out.write(buf.data(), buf.size()); written += buf.size(); buf.clear(); }
+    }
+    out.write(buf.data(), buf.size());
+    written += buf.size();
+    out.close();
+    recordWrite(filename, written);
+    if (!out) { cout << "❌ Write to " << filename << " failed.\n"; return false; }
+    double sec = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+    cout << "✔ Exported " << students.size() << " students to " << filename << " in " << sec << " s";
+    if (sec > 0) cout << " (" << (size_t)(students.size() / sec) << " rows/s)";
+    cout << "\n";
+    return true;
+}
+
+void importStudentsPrompt() {
+    string file; cout << "Enter CSV file to import: "; cin >> file;
+    importStudentsCsv(file);
+}
+
+void exportStudentsPrompt() {
+    string file; cout << "Enter CSV file to export to: "; cin >> file;
+    exportStudentsCsv(file);
+}
+
+// -------------------- Complaints --------------------
+// false if the roll does not exist
+bool raiseComplaint(int roll, const string &text, int priority, uint32_t &id) {
+    if (!rollExists(roll)) return false;
+    id = openTicket(roll, text, priority);
+    return true;
+}
+
+void appendTicketRow(string &out, const Ticket &t) {
+    out += '#'; out += to_string(t.id);
+    out += " | roll "; out += to_string(t.roll);
+    out += " | "; out += PRIORITY_NAMES[t.priority];
+    out += " | "; out += formatTime(t.openedAt);
+    out += " | "; out += t.text;
+    out += '\n';
+}
+
+// open-ticket queue, a page at a time, straight from the ordered open sets
+void viewComplaints() {
+    MetricTimer timer(OP_VIEW_COMPLAINTS);
+    if (openTicketCount() == 0) { cout << "✔ No complaints found.\n"; return; }
+    bool byPriority = false;
+    size_t pageSize = 1 << 16;
+    bool interactive = stdoutIsTerminal();
+    if (interactive) {
+        cout << "Order: 1. Oldest first  2. Highest priority first\nChoose: ";
+        int o; if (!(cin >> o)) { cin.clear(); o = 1; }
+        byPriority = o == 2;
+        pageSize = promptPageSize();
+    }
+    uint32_t cursor = 0;
+    size_t pageNo = 0;
+    while (true) {
+        vector<Ticket> page = openTicketPage(byPriority, cursor, pageSize);
+        if (page.empty()) { if (pageNo) cout << "Last page.\n"; return; }
+        cursor = page.back().id;
+        string out = "\n--- Open complaints" + (interactive ? " (page " + to_string(++pageNo) + ")" : string()) + " ---\n";
+        for (auto &t : page) appendTicketRow(out, t);
+        if (interactive) out += "[n]ext  [q]uit: ";
+        writeOut(out);
+        if (interactive) { string cmd; if (!(cin >> cmd) || cmd != "n") return; }
+    }
+}
+
+void solveComplaint() {
+    size_t open = openTicketCount();
+    if (open == 0) { cout << "✔ No complaints to solve.\n"; return; }
+    vector<Ticket> oldest = openTicketPage(false, 0, 1);
+    cout << open << " open ticket(s), oldest #" << (oldest.empty() ? 0 : oldest[0].id) << ".\n";
+    string sId; cout << "Enter ticket number to mark resolved: "; cin >> sId;
+    if (!sId.empty() && sId[0] == '#') sId.erase(0, 1);
+    if (!isDigits(sId)) { cout << "❌ Invalid ticket number.\n"; return; }
+    uint32_t id;
+    if (!parseIntView(sId, id) || !resolveTicket(id)) { cout << "❌ No open ticket #" << sId << ".\n"; return; }
+    cout << "✔ Ticket #" << id << " resolved.\n";
+}
+
+// -------------------- Class analytics --------------------
+struct ColumnStats {
+    double mean = 0, stddev = 0;
+    float min = 0, max = 0;
+};
+
+ColumnStats finishStats(size_t n, double sum, double sumSq, float mn, float mx) {
+    ColumnStats r;
+    if (n == 0) return r;
+    r.mean = sum / n;
+    r.stddev = sqrt(max(0.0, sumSq / n - r.mean * r.mean));
+    r.min = mn; r.max = mx;
+    return r;
+}
+
+ColumnStats columnStatsScalar(const float *v, size_t n) {
+    double sum = 0, sumSq = 0;
+    float mn = n ? v[0] : 0, mx = n ? v[0] : 0;
+    for (size_t i = 0; i < n; ++i) {
+        sum += v[i]; sumSq += (double)v[i] * v[i];
+        mn = min(mn, v[i]); mx = max(mx, v[i]);
+    }
+    return finishStats(n, sum, sumSq, mn, mx);
+}
+
+void addColumnScalar(float *dst, const float *src, size_t n) {
+    for (size_t i = 0; i < n; ++i) dst[i] += src[i];
+}
+
+#ifdef SRMS_AVX2
+// 8 marks per step; sums are widened to double so 1M rows do not lose precision
+__attribute__((target("avx2"))) ColumnStats columnStatsAvx2(const float *v, size_t n) {
+    if (n < 8) return columnStatsScalar(v, n);
+    __m256 vmin = _mm256_loadu_ps(v), vmax = vmin;
+    __m256d s0 = _mm256_setzero_pd(), s1 = s0, q0 = s0, q1 = s0;
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256 x = _mm256_loadu_ps(v + i);
+        vmin = _mm256_min_ps(vmin, x);
+        vmax = _mm256_max_ps(vmax, x);
+        __m256d lo = _mm256_cvtps_pd(_mm256_castps256_ps128(x));
+        __m256d hi = _mm256_cvtps_pd(_mm256_extractf128_ps(x, 1));
+        s0 = _mm256_add_pd(s0, lo); s1 = _mm256_add_pd(s1, hi);
+        q0 = _mm256_add_pd(q0, _mm256_mul_pd(lo, lo)); q1 = _mm256_add_pd(q1, _mm256_mul_pd(hi, hi));
+    }
+    alignas(32) double sd[4], qd[4];
+    alignas(32) float mnf[8], mxf[8];
+    _mm256_store_pd(sd, _mm256_add_pd(s0, s1));
+    _mm256_store_pd(qd, _mm256_add_pd(q0, q1));
+    _mm256_store_ps(mnf, vmin);
+    _mm256_store_ps(mxf, vmax);
+    double sum = sd[0] + sd[1] + sd[2] + sd[3], sumSq = qd[0] + qd[1] + qd[2] + qd[3];
+    float mn = *min_element(mnf, mnf + 8), mx = *max_element(mxf, mxf + 8);
+    for (; i < n; ++i) {
+        sum += v[i]; sumSq += (double)v[i] * v[i];
+        mn = min(mn, v[i]); mx = max(mx, v[i]);
+    }
+    return finishStats(n, sum, sumSq, mn, mx);
+}
+
+__attribute__((target("avx2"))) void addColumnAvx2(float *dst, const float *src, size_t n) {
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8)
+        _mm256_storeu_ps(dst + i, _mm256_add_ps(_mm256_loadu_ps(dst + i), _mm256_loadu_ps(src + i)));
+    for (; i < n; ++i) dst[i] += src[i];
+}
+
+bool hasAvx2() {
+    static const bool ok = __builtin_cpu_supports("avx2");
+    return ok;
+}
+#else
+bool hasAvx2() { return false; }
+#endif
+
+ColumnStats columnStats(const float *v, size_t n) {
+#ifdef SRMS_AVX2
+    if (hasAvx2()) return columnStatsAvx2(v, n);
+#endif
+    return columnStatsScalar(v, n);
+}
+
+void addColumn(float *dst, const float *src, size_t n) {
+#ifdef SRMS_AVX2
+    if (hasAvx2()) { addColumnAvx2(dst, src, n); return; }
+#endif
+    addColumnScalar(dst, src, n);
+}
+
+// per-student total over all subjects, indexed like students
+vector<float> studentTotals() {
+    size_t n = students.size();
+    vector<float> totals(n, 0.0f);
+    for (auto &col : markColumns) addColumn(totals.data(), col.data(), n);
+    return totals;
+}
+
+// positions of the k highest values, best first (ties broken by roll)
+vector<size_t> topK(const vector<float> &values, size_t k) {
+    vector<size_t> idx(values.size());
+    for (size_t i = 0; i < idx.size(); ++i) idx[i] = i;
+    k = min(k, idx.size());
+    auto better = [&](size_t a, size_t b) {
+        if (values[a] != values[b]) return values[a] > values[b];
+        return students[a].roll < students[b].roll;
+    };
+    if (k < idx.size()) nth_element(idx.begin(), idx.begin() + k, idx.end(), better);
+    idx.resize(k);
+    sort(idx.begin(), idx.end(), better);
+    return idx;
+}
+
+void printStatsRow(const string &label, const ColumnStats &s) {
+    cout << "  " << left << setw(10) << label << right << fixed << setprecision(2)
+         << " mean " << setw(7) << s.mean << "  min " << setw(6) << s.min << "  max " << setw(6) << s.max
+         << "  stddev " << setw(6) << s.stddev;
+}
+
+void classReport() {
+    {
+        shared_lock<shared_mutex> lk(storeMutex);
+        if (students.empty()) { cout << "No students present.\n"; return; }
+    }
+    string kStr; cout << "How many toppers to list? "; cin >> kStr;
+    size_t k = isDigits(kStr) ? stoul(kStr) : 5;
+    shared_lock<shared_mutex> lk(storeMutex);
+    if (students.empty()) { cout << "No students present.\n"; return; }
+
+    MetricTimer timer(OP_CLASS_REPORT);
+    auto t0 = chrono::steady_clock::now();
+    size_t n = students.size();
+    ColumnStats subj[MAX_SUBJECTS];
+    size_t subjTop[MAX_SUBJECTS];
+    for (int i = 0; i < numSubjects; ++i) {
+        subj[i] = columnStats(markColumns[i].data(), n);
+        subjTop[i] = topK(markColumns[i], 1)[0];
+    }
+    vector<float> totals = studentTotals();
+    ColumnStats tot = columnStats(totals.data(), n);
+    vector<size_t> top = topK(totals, k);
+    double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - t0).count();
+
+    ios oldState(nullptr);
+    oldState.copyfmt(cout);
+    cout << "\n---- CLASS REPORT (" << n << " students) ----\n";
+    for (int i = 0; i < numSubjects; ++i) {
+        printStatsRow(subjectNames[i], subj[i]);
+        cout << "  topper " << students[subjTop[i]].roll << "\n";
+    }
+    printStatsRow("Total", tot);
+    cout << "  (average " << tot.mean / numSubjects << ")\n";
+    cout << "Top " << top.size() << " by total:\n";
+    for (size_t r = 0; r < top.size(); ++r) {
+        const StudentRecord &st = students[top[r]];
+        cout << "  " << r + 1 << ". " << st.roll << " | " << nameOf(st) << " | total " << totals[top[r]]
+             << " | average " << totals[top[r]] / numSubjects << "\n";
+    }
+    cout << "Computed in " << setprecision(3) << ms << " ms (" << (hasAvx2() ? "AVX2" : "scalar") << " kernels)\n";
+    cout.copyfmt(oldState);
+}
+
+// -------------------- Report cards --------------------
+/*
+  One file per student, <dir>/<roll>.txt or .html, rendered from a template:
+    {{field}}                      replaced by the student's value
+    {{#subjects}} ... {{/subjects}} repeated once per subject
+  Student fields: roll name parentName parentMobile total maxTotal percentage grade
+                  rank classSize percentile date
+  Subject fields: subject mark maxMark subjectGrade subjectRank subjectPercentile
+  The template is compiled once into literal and field parts; cards are rendered
+  in parallel, each into its thread's buffer, and written with one write per file.
+*/
+enum CardField {
+    F_ROLL, F_NAME, F_PARENT_NAME, F_PARENT_MOBILE, F_TOTAL, F_MAX_TOTAL, F_PERCENTAGE, F_GRADE,
+    F_RANK, F_CLASS_SIZE, F_PERCENTILE, F_DATE,
+    F_SUBJECT, F_MARK, F_MAX_MARK, F_SUBJECT_GRADE, F_SUBJECT_RANK, F_SUBJECT_PERCENTILE,
+    F_COUNT, F_LITERAL = F_COUNT
+};
+const char *CARD_FIELD_NAMES[F_COUNT] = {
+    "roll", "name", "parentName", "parentMobile", "total", "maxTotal", "percentage", "grade",
+    "rank", "classSize", "percentile", "date",
+    "subject", "mark", "maxMark", "subjectGrade", "subjectRank", "subjectPercentile"
+};
+
+struct CardPart {
+    CardField field;
+    string text; // F_LITERAL only
+};
+
+// parts before, inside and after the {{#subjects}} block
+struct CardTemplate {
+    vector<CardPart> head, row, tail;
+    bool html = false;
+};
+
+const char *DEFAULT_TEXT_CARD =
+    "REPORT CARD                                   {{date}}\n"
+    "======================================================\n"
+    "Roll   : {{roll}}\n"
+    "Name   : {{name}}\n"
+    "Parent : {{parentName}} ({{parentMobile}})\n"
+    "------------------------------------------------------\n"
+    "{{#subjects}}{{subject}}: {{mark}} / {{maxMark}}   grade {{subjectGrade}}   rank {{subjectRank}} of {{classSize}}\n{{/subjects}}"
+    "------------------------------------------------------\n"
+    "Total  : {{total}} / {{maxTotal}} ({{percentage}}%)   grade {{grade}}\n"
+    "Rank   : {{rank}} of {{classSize}}   percentile {{percentile}}\n";
+
+const char *DEFAULT_HTML_CARD =
+    "<!DOCTYPE html>\n<html><head><meta charset=\"utf-8\"><title>Report card {{roll}}</title></head><body>\n"
+    "<h1>Report card</h1>\n<p>{{name}} (roll {{roll}})<br>Parent: {{parentName}}, {{parentMobile}}<br>{{date}}</p>\n"
+    "<table border=\"1\" cellpadding=\"4\">\n<tr><th>Subject</th><th>Mark</th><th>Grade</th><th>Rank</th></tr>\n"
+    "{{#subjects}}<tr><td>{{subject}}</td><td>{{mark}} / {{maxMark}}</td><td>{{subjectGrade}}</td><td>{{subjectRank}} of {{classSize}}</td></tr>\n{{/subjects}}"
+    "<tr><th>Total</th><th>{{total}} / {{maxTotal}} ({{percentage}}%)</th><th>{{grade}}</th><th>{{rank}} of {{classSize}}</th></tr>\n"
+    "</table>\n<p>Percentile: {{percentile}}</p>\n</body></html>\n";
+
+// grade for a percentage
+const char *gradeFor(double percent) {
+    static const pair<double, const char *> GRADES[] = {{90, "A+"}, {80, "A"}, {70, "B"}, {60, "C"}, {50, "D"}, {40, "E"}};
+    for (auto &g : GRADES) if (percent >= g.first) return g.second;
+    return "F";
+}
+
+// false with err set for an unknown field or an unbalanced subjects block
+bool compileCardTemplate(string_view src, bool html, CardTemplate &out, string &err) {
+    out = CardTemplate();
+    out.html = html;
+    vector<CardPart> *cur = &out.head;
+    int block = 0; // 0 before, 1 inside, 2 after the subjects block
+    while (!src.empty()) {
+        size_t open = src.find("{{");
+        if (open != 0) {
+            cur->push_back({F_LITERAL, string(src.substr(0, open))});
+            if (open == string_view::npos) break;
+        }
+        size_t close = src.find("}}", open);
+        if (close == string_view::npos) { err = "unclosed {{"; return false; }
+        string_view name = trimView(src.substr(open + 2, close - open - 2));
+        src.remove_prefix(close + 2);
+        if (name == "#subjects") {
+            if (block != 0) { err = "only one {{#subjects}} block is allowed"; return false; }
+            block = 1; cur = &out.row;
+            continue;
+        }
+        if (name == "/subjects") {
+            if (block != 1) { err = "{{/subjects}} without {{#subjects}}"; return false; }
+            block = 2; cur = &out.tail;
+            continue;
+        }
+        int f = 0;
+        while (f < F_COUNT && name != CARD_FIELD_NAMES[f]) ++f;
+        if (f == F_COUNT) { err = "unknown field {{" + string(name) + "}}"; return false; }
+        if (f >= F_SUBJECT && block != 1) { err = "{{" + string(name) + "}} is only valid inside {{#subjects}}"; return false; }
+        cur->push_back({(CardField)f, ""});
+    }
+    if (block == 1) { err = "{{#subjects}} is not closed"; return false; }
+    return true;
+}
+
+void appendEscaped(string &out, string_view s, bool html) {
+    if (!html) { out += s; return; }
+    for (char c : s) {
+        if (c == '&') out += "&amp;";
+        else if (c == '<') out += "&lt;";
+        else if (c == '>') out += "&gt;";
+        else if (c == '"') out += "&quot;";
+        else out += c;
+    }
+}
+
+void appendFixed1(string &out, double v) {
+    char buf[32];
+    auto r = to_chars(buf, buf + sizeof(buf), v, chars_format::fixed, 1);
+    out.append(buf, r.ptr);
+}
+
+// everything a card shows for one student
+struct CardData {
+    const StudentRecord *record;
+    float marks[MAX_SUBJECTS];
+    float total;
+    Rank ranks[MAX_SUBJECTS], totalRank;
+    string_view date;
+};
+
+void appendCardParts(string &out, const vector<CardPart> &parts, const CardData &d, int subject, bool html) {
+    char mobile[16];
+    for (auto &p : parts) {
+        switch (p.field) {
+        case F_LITERAL: out += p.text; break;
+        case F_ROLL: out += to_string(d.record->roll); break;
+        case F_NAME: appendEscaped(out, nameOf(*d.record), html); break;
+        case F_PARENT_NAME: appendEscaped(out, parentNameOf(*d.record), html); break;
+        case F_PARENT_MOBILE: appendEscaped(out, mobileView(d.record->mobile, mobile), html); break;
+        case F_TOTAL: appendFloat(out, d.total); break;
+        case F_MAX_TOTAL: out += to_string(numSubjects * 100); break;
+        case F_PERCENTAGE: appendFixed1(out, d.total / numSubjects); break;
+        case F_GRADE: out += gradeFor(d.total / numSubjects); break;
+        case F_RANK: out += to_string(d.totalRank.rank); break;
+        case F_CLASS_SIZE: out += to_string(d.totalRank.classSize); break;
+        case F_PERCENTILE: appendFixed1(out, d.totalRank.percentile); break;
+        case F_DATE: out += d.date; break;
+        case F_SUBJECT: out += subjectNames[subject]; break;
+        case F_MARK: appendFloat(out, d.marks[subject]); break;
+        case F_MAX_MARK: out += "100"; break;
+        case F_SUBJECT_GRADE: out += gradeFor(d.marks[subject]); break;
+        case F_SUBJECT_RANK: out += to_string(d.ranks[subject].rank); break;
+        case F_SUBJECT_PERCENTILE: appendFixed1(out, d.ranks[subject].percentile); break;
+        default: break;
+        }
+    }
+}
+
+// caller holds storeMutex and has built the rank index
+void renderCard(string &out, const CardTemplate &t, size_t pos, string_view date) {
+    CardData d;
+    d.record = &students[pos];
+    marksAt(pos, d.marks);
+    d.total = rowTotal(pos);
+    for (int i = 0; i < numSubjects; ++i) d.ranks[i] = rankIn(subjectRanks[i], scoreBucket(d.marks[i], SUBJECT_BUCKETS));
+    d.totalRank = rankIn(totalRanks, scoreBucket(d.total, totalBuckets()));
+    d.date = date;
+    appendCardParts(out, t.head, d, 0, t.html);
+    for (int i = 0; i < numSubjects && !t.row.empty(); ++i) appendCardParts(out, t.row, d, i, t.html);
+    appendCardParts(out, t.tail, d, 0, t.html);
+}
+
+// one write, no fsync: cards are output, not data of record
+bool writeWhole(const string &filename, const string &data) {
+    ofstream f(filename, ios::binary | ios::trunc);
+    f.write(data.data(), (streamsize)data.size());
+    f.close();
+    recordWrite(filename, data.size());
+    return (bool)f;
+}
+
+// usage: srms --report-cards <dir> [text|html] [template file]
+bool writeReportCards(const string &dir, bool html, const string &templateFile) {
+    MetricTimer timer(OP_REPORT_CARDS);
+    string src = html ? DEFAULT_HTML_CARD : DEFAULT_TEXT_CARD;
+    if (!templateFile.empty()) {
+        MappedFile f(templateFile);
+        if (!f.isOpen()) { cout << "❌ Cannot open " << templateFile << ".\n"; return false; }
+        src.assign(f.view());
+    }
+    CardTemplate tmpl;
+    string err;
+    if (!compileCardTemplate(src, html, tmpl, err)) { cout << "❌ Template: " << err << ".\n"; return false; }
+    error_code ec;
+    filesystem::create_directories(dir, ec);
+    if (!filesystem::is_directory(dir)) { cout << "❌ Cannot create " << dir << ".\n"; return false; }
+
+    ensureRankIndex();
+    auto t0 = chrono::steady_clock::now();
+    string date = formatTime(nowSeconds()).substr(0, 10);
+    string ext = html ? ".html" : ".txt";
+    shared_lock<shared_mutex> lk(storeMutex);
+    const size_t n = students.size(), CHUNK = 256;
+    atomic<size_t> failed{0};
+    parallelForStealing((n + CHUNK - 1) / CHUNK, hardwareThreads(), [&](size_t chunk) {
+        thread_local string buf;
+        string path;
+        for (size_t pos = chunk * CHUNK; pos < min(n, (chunk + 1) * CHUNK); ++pos) {
+            buf.clear();
+            renderCard(buf, tmpl, pos, date);
+            path = dir + "/" + to_string(students[pos].roll) + ext;
+            if (!writeWhole(path, buf)) failed.fetch_add(1, memory_order_relaxed);
+        }
+    });
+    double sec = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+    if (failed) cout << "❌ " << failed << " report cards could not be written.\n";
+    cout << "✔ Wrote " << n - failed << " report cards to " << dir << " in " << sec << " s";
+    if (sec > 0) cout << " (" << (size_t)(n / sec) << " cards/s)";
+    cout << "\n";
+    return failed == 0;
+}
+
+void reportCardsPrompt() {
+    string dir, format, tmpl;
+    cout << "Directory for the report cards: "; cin >> dir;
+    cout << "Format (text/html): "; cin >> format;
+    cout << "Template file (- for the built-in one): "; cin >> tmpl;
+    writeReportCards(dir, format == "html", tmpl == "-" ? "" : tmpl);
+}
+
+// -------------------- Marks history --------------------
+/*
+  marks.history, append-only, one block per closed term (host byte order, as students.bin):
+    header   : magic[8] "SRMSTRM", u32 version, u32 byteOrder, u32 numSubjects, u32 count,
+               u64 blockSize, i64 closedAt, u32 labelLength, u32 subjectsLength
+    directory: (1 + numSubjects) x { u64 offset, u64 sum, i64 base, u32 bits, u32 reserved }
+    label    : labelLength bytes, then subjectsLength bytes of subject names separated
+               by ',', zero-padded to 8
+    columns  : the rolls in ascending order, then one column per subject in hundredths
+               of a mark; each value is stored as (value - base) in bits bits, packed
+               into u64 words
+  Columns are fixed width, so they support random access. A student's mark in a term
+  costs a binary search of the roll column plus one read of that subject's column, so a
+  trend touches a few pages per term. sum holds the column total, which lets class
+  averages skip the columns entirely. A torn last block is ignored and then cut off
+  before the next term is appended.
+  Each block names its own subjects, so terms closed under another schema stay
+  readable; queries match subjects by name. Version 1 blocks have DEFAULT_SUBJECTS.
+*/
+const string HISTORY_FILE = "marks.history";
+const char TERM_MAGIC[8] = {'S','R','M','S','T','R','M','\0'};
+const uint32_t TERM_VERSION = 2;
+const size_t TERM_HEADER_SIZE = 8 + 4 * 4 + 8 + 8 + 4 + 4;
+const size_t TERM_COLUMN_SIZE = 8 + 8 + 8 + 4 + 4;
+const size_t MAX_TERM_LABEL = 32;
+// marks are kept to 0.01
+const int HISTORY_SCALE = 100;
+
+// one bit-packed column inside the mapped history file
+struct PackedColumn {
+    const char *words = nullptr;
+    int64_t base = 0;
+    uint32_t bits = 0;
+    uint64_t sum = 0;
+    int64_t at(size_t i) const {
+        if (bits == 0) return base;
+        size_t bit = i * bits, w = bit >> 6, shift = bit & 63;
+        uint64_t v = getRaw<uint64_t>(words + 8 * w) >> shift;
+        if (shift + bits > 64) v |= getRaw<uint64_t>(words + 8 * (w + 1)) << (64 - shift);
+        return base + (int64_t)(v & ((1ULL << bits) - 1));
+    }
+};
+
+struct Term {
+    string label;
+    int64_t closedAt = 0;
+    uint32_t count = 0;
+    vector<string> subjects;
+    PackedColumn rolls, marks[MAX_SUBJECTS];
+    // the column of a subject of the active schema, -1 if the term did not have it
+    int column(int subject) const {
+        auto it = find(subjects.begin(), subjects.end(), subjectNames[subject]);
+        return it == subjects.end() ? -1 : (int)(it - subjects.begin());
+    }
+};
+
+// closed terms, oldest first; their columns point into historyMap
+vector<Term> terms;
+unique_ptr<MappedFile> historyMap;
+// bytes of marks.history holding whole blocks; anything after them is a torn append
+uint64_t historyValidBytes = 0;
+// guards terms, historyMap and marks.history; taken before storeMutex
+shared_mutex historyMutex;
+
+uint32_t bitsFor(uint64_t range) {
+    uint32_t b = 0;
+    for (; range; range >>= 1) ++b;
+    return b;
+}
+
+size_t packedBytes(size_t count, uint32_t bits) { return (count * bits + 63) / 64 * 8; }
+
+// (v - base) in bits bits each, low bits first, appended as u64 words
+void packColumn(string &out, const vector<int64_t> &values, int64_t base, uint32_t bits) {
+    if (bits == 0) return;
+    uint64_t word = 0;
+    uint32_t used = 0;
+    for (int64_t v : values) {
+        uint64_t d = (uint64_t)(v - base);
+        word |= d << used;
+        if (used + bits < 64) { used += bits; continue; }
+        putRaw<uint64_t>(out, word);
+        word = used ? d >> (64 - used) : 0;
+        used = used + bits - 64;
+    }
+    if (used) putRaw<uint64_t>(out, word);
+}
+
+// the current marks of the roster as one term block (caller holds storeMutex)
+string encodeTermBlock(const string &label, int64_t closedAt) {
+    size_t n = students.size();
+    vector<pair<int, size_t>> order(n);
+    for (size_t pos = 0; pos < n; ++pos) order[pos] = {students[pos].roll, pos};
+    sort(order.begin(), order.end());
+    vector<vector<int64_t>> columns(1 + numSubjects, vector<int64_t>(n));
+    for (size_t i = 0; i < n; ++i) {
+        columns[0][i] = order[i].first;
+        for (int s = 0; s < numSubjects; ++s) columns[1 + s][i] = lround(markColumns[s][order[i].second] * HISTORY_SCALE);
+    }
+    string names = joinSubjects(subjectNames);
+    size_t namesPadded = (label.size() + names.size() + 7) / 8 * 8;
+    size_t offset = TERM_HEADER_SIZE + (1 + numSubjects) * TERM_COLUMN_SIZE + namesPadded;
+    string directory, body;
+    for (auto &c : columns) {
+        auto range = minmax_element(c.begin(), c.end());
+        int64_t lo = n ? *range.first : 0, hi = n ? *range.second : 0;
+        uint32_t bits = bitsFor((uint64_t)(hi - lo));
+        uint64_t sum = 0;
+        for (int64_t v : c) sum += (uint64_t)v;
+        putRaw<uint64_t>(directory, offset + body.size());
+        putRaw<uint64_t>(directory, sum);
+        putRaw<int64_t>(directory, lo);
+        putRaw<uint32_t>(directory, bits);
+        putRaw<uint32_t>(directory, 0);
+        packColumn(body, c, lo, bits);
+    }
+    string out;
+    out.reserve(offset + body.size());
+    out.append(TERM_MAGIC, 8);
+    putRaw<uint32_t>(out, TERM_VERSION);
+    putRaw<uint32_t>(out, BIN_BYTE_ORDER);
+    putRaw<uint32_t>(out, numSubjects);
+    putRaw<uint32_t>(out, (uint32_t)n);
+    putRaw<uint64_t>(out, offset + body.size());
+    putRaw<int64_t>(out, closedAt);
+    putRaw<uint32_t>(out, (uint32_t)label.size());
+    putRaw<uint32_t>(out, (uint32_t)names.size());
+    out += directory;
+    out += label;
+    out += names;
+    out.append(namesPadded - label.size() - names.size(), '\0');
+    out += body;
+    return out;
+}
+
+// the block at the front of data; false if it is cut short or damaged
+bool decodeTermBlock(string_view data, Term &t, uint64_t &blockSize) {
+    if (data.size() < TERM_HEADER_SIZE || memcmp(data.data(), TERM_MAGIC, 8) != 0) return false;
+    const char *p = data.data() + 8;
+    uint32_t version = getRaw<uint32_t>(p);
+    if ((version != 1 && version != TERM_VERSION) || getRaw<uint32_t>(p + 4) != BIN_BYTE_ORDER) return false;
+    uint32_t subjects = getRaw<uint32_t>(p + 8);
+    t.count = getRaw<uint32_t>(p + 12);
+    blockSize = getRaw<uint64_t>(p + 16);
+    t.closedAt = getRaw<int64_t>(p + 24);
+    uint64_t labelLength = getRaw<uint32_t>(p + 32), namesLength = version == 1 ? 0 : getRaw<uint32_t>(p + 36);
+    if (subjects > (uint32_t)MAX_SUBJECTS) return false;
+    size_t labelAt = TERM_HEADER_SIZE + (1 + subjects) * TERM_COLUMN_SIZE;
+    if (labelLength > MAX_TERM_LABEL || blockSize > data.size() || blockSize < labelAt + labelLength + namesLength) return false;
+    t.label.assign(data.data() + labelAt, labelLength);
+    if (version == 1) t.subjects = DEFAULT_SUBJECTS;
+    else if (!parseSubjectList(data.substr(labelAt + labelLength, namesLength), t.subjects).empty()) return false;
+    if (t.subjects.size() != subjects) return false;
+    const char *entry = data.data() + TERM_HEADER_SIZE;
+    for (uint32_t c = 0; c <= subjects; ++c, entry += TERM_COLUMN_SIZE) {
+        PackedColumn &col = c == 0 ? t.rolls : t.marks[c - 1];
+        uint64_t offset = getRaw<uint64_t>(entry);
+        col.sum = getRaw<uint64_t>(entry + 8);
+        col.base = getRaw<int64_t>(entry + 16);
+        col.bits = getRaw<uint32_t>(entry + 24);
+        if (col.bits > 63 || offset > blockSize || packedBytes(t.count, col.bits) > blockSize - offset) return false;
+        col.words = data.data() + offset;
+    }
+    return true;
+}
+
+// lists the blocks of historyMap up to the first bad one (caller holds historyMutex exclusively)
+void indexHistory() {
+    terms.clear();
+    historyValidBytes = 0;
+    if (!historyMap->isOpen()) return;
+    string_view data = historyMap->view();
+    uint64_t blockSize;
+    Term t;
+    while (historyValidBytes < data.size() && decodeTermBlock(data.substr(historyValidBytes), t, blockSize)) {
+        terms.push_back(std::move(t));
+        historyValidBytes += blockSize;
+    }
+}
+
+void loadHistory() {
+    unique_lock<shared_mutex> lk(historyMutex);
+    terms.clear();
+    historyMap = make_unique<MappedFile>(HISTORY_FILE, false);
+    indexHistory();
+    size_t size = historyMap->view().size();
+    if (historyValidBytes < size)
+        cout << "⚠ Ignoring " << size - historyValidBytes << " damaged byte(s) at the end of " << HISTORY_FILE << ".\n";
+}
+
+string validateTermLabel(const string &label) {
+    if (label.empty() || label.size() > MAX_TERM_LABEL) return "term label must be 1-" + to_string(MAX_TERM_LABEL) + " characters";
+    for (char c : label)
+        if (!isalnum((unsigned char)c) && c != '-' && c != '_' && c != '.') return "term label: only letters, digits, - _ and . allowed";
+    return "";
+}
+
+// appends the current marks of every student as a closed term and leaves the roster
+// as it is; empty string on success, otherwise the reason
+string closeTermRecord(const string &label, size_t &count, size_t &bytes) {
+    MetricTimer timer(OP_CLOSE_TERM);
+    string err = validateTermLabel(label);
+    if (!err.empty()) return err;
+    unique_lock<shared_mutex> hl(historyMutex);
+    if (!historyMap) { terms.clear(); historyMap = make_unique<MappedFile>(HISTORY_FILE, false); indexHistory(); }
+    for (auto &t : terms) if (t.label == label) return "term " + label + " is already closed";
+    string block;
+    {
+        shared_lock<shared_mutex> lk(storeMutex);
+        count = students.size();
+        if (count) block = encodeTermBlock(label, nowSeconds());
+    }
+    if (!count) return "no students to record";
+    bytes = block.size();
+    error_code ec;
+    if (historyValidBytes < historyMap->view().size()) filesystem::resize_file(HISTORY_FILE, historyValidBytes, ec);
+    if (ec || !writeDurable(HISTORY_FILE, block, true)) return "could not write " + HISTORY_FILE;
+    terms.clear();
+    historyMap = make_unique<MappedFile>(HISTORY_FILE, false);
+    indexHistory();
+    return "";
+}
+
+// position of roll in a term, NO_POS if the student was not on the roster then
+size_t termPos(const Term &t, int roll) {
+    size_t lo = 0, hi = t.count;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (t.rolls.at(mid) < roll) lo = mid + 1; else hi = mid;
+    }
+    return lo < t.count && t.rolls.at(lo) == roll ? lo : NO_POS;
+}
+
+struct TermMarks {
+    string label;
+    bool enrolled = false;
+    float marks[MAX_SUBJECTS] = {};
+};
+
+// one row per closed term, oldest first; subject < 0 reads every subject column,
+// otherwise only that one and the other marks stay 0. A subject the term did not
+// have reads as NAN.
+vector<TermMarks> marksHistory(int roll, int subject) {
+    MetricTimer timer(OP_HISTORY);
+    shared_lock<shared_mutex> lk(historyMutex);
+    vector<TermMarks> out(terms.size());
+    for (size_t i = 0; i < terms.size(); ++i) {
+        const Term &t = terms[i];
+        out[i].label = t.label;
+        size_t pos = termPos(t, roll);
+        if (pos == NO_POS) continue;
+        out[i].enrolled = true;
+        for (int s = 0; s < numSubjects; ++s) {
+            if (subject >= 0 && s != subject) continue;
+            int c = t.column(s);
+            out[i].marks[s] = c < 0 ? NAN : (float)t.marks[c].at(pos) / HISTORY_SCALE;
+        }
+    }
+    return out;
+}
+
+struct TermAverages {
+    string label;
+    size_t count = 0;
+    double average[MAX_SUBJECTS] = {};
+};
+
+// class average per subject for every closed term, from the column sums alone;
+// NAN for a subject the term did not have
+vector<TermAverages> termAverages() {
+    MetricTimer timer(OP_HISTORY);
+    shared_lock<shared_mutex> lk(historyMutex);
+    vector<TermAverages> out(terms.size());
+    for (size_t i = 0; i < terms.size(); ++i) {
+        out[i].label = terms[i].label;
+        out[i].count = terms[i].count;
+        for (int s = 0; s < numSubjects; ++s) {
+            int c = terms[i].column(s);
+            out[i].average[s] = c < 0 ? NAN : terms[i].count ? (double)terms[i].marks[c].sum / HISTORY_SCALE / terms[i].count : 0;
+        }
+    }
+    return out;
+}
+
+bool closeTerm(const string &label) {
+    size_t count = 0, bytes = 0;
+    string err = closeTermRecord(label, count, bytes);
+    if (!err.empty()) { cout << "❌ Cannot close term: " << err << ".\n"; return false; }
+    cout << "✔ Closed term " << label << ": " << count << " students in " << bytes << " bytes ("
+         << fixed << setprecision(1) << (double)bytes / count << " per student).\n";
+    cout.unsetf(ios::floatfield);
+    cout << setprecision(6);
+    return true;
+}
+
+// subject < 0 prints every subject and the total, otherwise one subject and the change per term
+void printMarksHistory(int roll, int subject) {
+    vector<TermMarks> rows = marksHistory(roll, subject);
+    Student now;
+    Rank ranks[MAX_SUBJECTS], total;
+    bool current = publishedStudent(roll, now, ranks, total);
+    if (rows.empty()) { cout << "No closed terms yet.\n"; return; }
+    int first = subject < 0 ? 0 : subject, last = subject < 0 ? numSubjects : subject + 1;
+    ios oldState(nullptr);
+    oldState.copyfmt(cout);
+    cout << "\n---- MARKS HISTORY (roll " << roll << ") ----\n";
+    cout << left << setw(16) << "Term" << right;
+    for (int s = first; s < last; ++s) cout << setw(11) << subjectNames[s];
+    cout << setw(10) << (subject < 0 ? "Total" : "Change") << "\n";
+    bool havePrevious = false;
+    float previous = 0;
+    auto printRow = [&](const string &label, bool enrolled, const float *marks) {
+        cout << left << setw(16) << label << right;
+        if (!enrolled) { cout << setw(11) << "-" << "\n"; return; }
+        float total = 0;
+        for (int s = first; s < last; ++s) {
+            if (isnan(marks[s])) { cout << setw(11) << "-"; continue; }
+            cout << setw(11) << marks[s];
+            total += marks[s];
+        }
+        if (subject < 0) cout << setw(10) << total;
+        else if (isnan(marks[subject])) { cout << "\n"; return; }
+        else if (havePrevious) cout << setw(10) << showpos << total - previous << noshowpos;
+        cout << "\n";
+        havePrevious = true;
+        previous = total;
+    };
+    for (auto &r : rows) printRow(r.label, r.enrolled, r.marks);
+    if (current) printRow("(current)", true, now.marks);
+    cout.copyfmt(oldState);
+}
+
+void printTermAverages() {
+    vector<TermAverages> rows = termAverages();
+    if (rows.empty()) { cout << "No closed terms yet.\n"; return; }
+    ios oldState(nullptr);
+    oldState.copyfmt(cout);
+    cout << "\n---- CLASS AVERAGE PER TERM ----\n";
+    cout << left << setw(16) << "Term" << right << setw(10) << "Students";
+    for (int s = 0; s < numSubjects; ++s) cout << setw(11) << subjectNames[s];
+    cout << setw(10) << "Overall" << "\n" << fixed << setprecision(2);
+    for (auto &r : rows) {
+        cout << left << setw(16) << r.label << right << setw(10) << r.count;
+        double overall = 0;
+        int recorded = 0;
+        for (int s = 0; s < numSubjects; ++s) {
+            if (isnan(r.average[s])) { cout << setw(11) << "-"; continue; }
+            cout << setw(11) << r.average[s];
+            overall += r.average[s];
+            ++recorded;
+        }
+        cout << setw(10) << (recorded ? overall / recorded : 0) << "\n";
+    }
+    cout.copyfmt(oldState);
+}
+
+// subject by number, -1 for all of them; -2 for an invalid choice
+int promptSubjectOrAll() {
+    cout << "0. All subjects\n";
+    for (int i = 0; i < numSubjects; ++i) cout << i + 1 << ". " << subjectNames[i] << "\n";
+    cout << "Choose subject number: ";
+    int si;
+    if (!(cin >> si)) { cin.clear(); return -2; }
+    return si >= 0 && si <= numSubjects ? si - 1 : -2;
+}
+
+void termHistoryMenu() {
+    cout << "1. Close Term\n2. Student History\n3. Class Average per Term\nChoose: ";
+    int ch; cin >> ch;
+    if (ch == 1) {
+        string label;
+        cout << "Term label (e.g. 2025-T1): "; cin >> label;
+        closeTerm(label);
+    } else if (ch == 2) {
+        string sRoll; cout << "Enter roll number: "; cin >> sRoll;
+        if (!isDigits(sRoll)) { cout << "❌ Invalid roll input.\n"; return; }
+        int subject = promptSubjectOrAll();
+        if (subject == -2) { cout << "❌ Invalid choice.\n"; return; }
+        printMarksHistory(stoi(sRoll), subject);
+    } else if (ch == 3) {
+        printTermAverages();
+    } else {
+        cout << "❌ Invalid choice.\n";
+    }
+}
+
+// -------------------- Metrics report --------------------
+string formatNs(uint64_t ns) {
+    ostringstream o;
+    o << fixed << setprecision(1);
+    if (ns < 1000) o << ns << " ns";
+    else if (ns < 1000000) o << ns / 1e3 << " us";
+    else if (ns < 1000000000) o << ns / 1e6 << " ms";
+    else o << ns / 1e9 << " s";
+    return o.str();
+}
+
+void metricsReport() {
+    MetricsSnapshot s = collectMetrics();
+    cout << "\n--- METRICS (since start) ---\n";
+    cout << left << setw(22) << "Operation" << right << setw(10) << "Count" << setw(12) << "Mean"
+         << setw(12) << "p50 <=" << setw(12) << "p99 <=" << "\n";
+    for (int op = 0; op < OP_COUNT; ++op) {
+        if (!s.count[op]) continue;
+        cout << left << setw(22) << METRIC_OP_NAMES[op] << right << setw(10) << s.count[op]
+             << setw(12) << formatNs(s.totalNs[op] / s.count[op])
+             << setw(12) << formatNs(latencyQuantileNs(s, op, 0.50))
+             << setw(12) << formatNs(latencyQuantileNs(s, op, 0.99)) << "\n";
+    }
+    cout << "\n" << left << setw(22) << "File" << right << setw(14) << "Bytes read" << setw(16) << "Bytes written" << "\n";
+    for (int f = 0; f < METRIC_FILE_COUNT; ++f) {
+        if (!s.bytesRead[f] && !s.bytesWritten[f]) continue;
+        cout << left << setw(22) << METRIC_FILES[f] << right << setw(14) << s.bytesRead[f] << setw(16) << s.bytesWritten[f] << "\n";
+    }
+    cout << left;
+}
+
+bool writeMetricsFile(const string &filename) {
+    // not routed through writeFileAtomic so the dump does not count itself
+    ofstream out(filename + ".tmp", ios::binary | ios::trunc);
+    out << prometheusMetrics();
+    out.close();
+    if (!out) return false;
+    error_code ec;
+    filesystem::rename(filename + ".tmp", filename, ec);
+    return !ec;
+}
+
+void writeMetricsPrompt() {
+    string file; cout << "Enter file for Prometheus metrics: "; cin >> file;
+    if (writeMetricsFile(file)) cout << "✔ Metrics written to " << file << ".\n";
+    else cout << "❌ Cannot write " << file << ".\n";
+}
+
+// set by --metrics-out; dumped when the process exits
+string metricsOutFile;
+
+// -------------------- Memory report --------------------
+// resident set size from /proc, 0 where it is not available
+size_t residentBytes() {
+    ifstream in("/proc/self/status");
+    string line;
+    while (getline(in, line))
+        if (line.compare(0, 6, "VmRSS:") == 0) return (size_t)atoll(line.c_str() + 6) * 1024;
+    return 0;
+}
+
+// estimated bytes held by the roster: the current layout against one std::string-based
+// Student per row (heap buffer past the SSO limit) plus the same mark columns
+void memoryReport() {
+    shared_lock<shared_mutex> lk(storeMutex);
+    size_t n = students.size();
+    const size_t sso = string().capacity();
+    size_t oldHeap = 0;
+    char buf[16];
+    for (auto &r : students) {
+        for (string_view f : {nameOf(r), parentNameOf(r), mobileView(r.mobile, buf)})
+            if (f.size() > sso) oldHeap += f.size() + 1;
+    }
+    size_t columns = 0;
+    for (auto &c : markColumns) columns += c.capacity() * sizeof(float);
+    // node (key, value, next, cached hash) plus one bucket pointer per entry
+    size_t rollBytes = rollIndex.size() * 32 + rollIndex.bucket_count() * sizeof(void *);
+    size_t oldBytes = students.capacity() * sizeof(Student) + oldHeap + columns + rollBytes;
+    size_t newBytes = students.capacity() * sizeof(StudentRecord) + namePool.arenaBytes() + namePool.indexBytes() + columns + rollBytes;
+    auto perStudent = [n](size_t bytes) { return n ? (double)bytes / n : 0.0; };
+    ios oldState(nullptr);
+    oldState.copyfmt(cout);
+    cout << fixed << setprecision(1);
+    cout << "\n--- MEMORY (" << n << " students, " << namePool.size() << " distinct strings) ---\n";
+    cout << left << setw(26) << "Records" << right << setw(14) << students.capacity() * sizeof(StudentRecord) << " bytes\n";
+    cout << left << setw(26) << "String arena" << right << setw(14) << namePool.arenaBytes() << " bytes\n";
+    cout << left << setw(26) << "String index" << right << setw(14) << namePool.indexBytes() << " bytes\n";
+    cout << left << setw(26) << "Mark columns" << right << setw(14) << columns << " bytes\n";
+    cout << left << setw(26) << "Roll index (est.)" << right << setw(14) << rollBytes << " bytes\n";
+    cout << left << setw(26) << "Total" << right << setw(14) << newBytes << " bytes, " << perStudent(newBytes) << " per student\n";
+    cout << left << setw(26) << "As std::string records" << right << setw(14) << oldBytes << " bytes, " << perStudent(oldBytes) << " per student\n";
+    if (size_t rss = residentBytes()) cout << left << setw(26) << "Process RSS" << right << setw(14) << rss << " bytes\n";
+    cout.copyfmt(oldState);
+}
+
+// -------------------- Student / Parent actions --------------------
+// both portals read the published results snapshot, never the live store
+void studentView(int roll) {
+    Student st;
+    Rank ranks[MAX_SUBJECTS], total;
+    if (!publishedStudent(roll, st, ranks, total)) { cout << "❌ Student record not found.\n"; return; }
+    cout << "\n=============================\n";
+    cout << "       🧑‍🎓 STUDENT PORTAL\n";
+    cout << "=============================\n";
+    printStudentSummary(st, ranks, total);
+}
+
+void parentView(int roll) {
+    Student st;
+    Rank ranks[MAX_SUBJECTS], total;
+    if (!publishedStudent(roll, st, ranks, total)) { cout << "❌ Student record not found.\n"; return; }
+    cout << "\n=============================\n";
+    cout << "        PARENT VIEW\n";
+    cout << "=============================\n";
+    printStudentSummary(st, ranks, total);
+}
+
+void raiseComplaintWithConfirm(int roll) {
+    cin.ignore();
+    cout << "Enter your complaint (single line):\n";
+    string complaintText;
+    getline(cin, complaintText);
+    complaintText = trim(complaintText);
+    if (complaintText.empty()) { cout << "❌ Complaint cannot be empty.\n"; return; }
+
+    cout << "Priority: 1. High  2. Normal  3. Low\nChoose: ";
+    int priority; if (!(cin >> priority)) { cin.clear(); priority = PRIORITY_NORMAL; }
+    if (priority < PRIORITY_HIGH || priority > PRIORITY_LOW) priority = PRIORITY_NORMAL;
+
+    cout << "\nYou entered:\n\"" << complaintText << "\" (" << PRIORITY_NAMES[priority] << " priority)\n";
+    cout << "Submit complaint? (Y/N): ";
+    char ch; cin >> ch;
+    if (ch == 'Y' || ch == 'y') {
+        uint32_t id;
+        if (!raiseComplaint(roll, complaintText, priority, id)) { cout << "❌ Student not found.\n"; return; }
+        cout << "✔ Complaint submitted as ticket #" << id << ".\n";
+    } else {
+        cout << "Complaint cancelled.\n";
+    }
+}
+
+// -------------------- Main menu & flow --------------------
+// ticket log, then any complaints still stored the old way in the roster files
+void loadComplaints() {
+    loadTicketLog();
+    bool legacy = !legacyComplaints.empty();
+    size_t migrated = migrateLegacyComplaints();
+    if (legacy) compactDataFiles(); // the snapshot no longer carries them
+    error_code ec;
+    if (legacy || filesystem::exists(COMPLAINTS_FILE)) filesystem::remove(COMPLAINTS_FILE, ec);
+    if (migrated) cout << "✔ Moved " << migrated << " complaint(s) to " << COMPLAINT_LOG << ".\n";
+}
+
+void loadAll() {
+    loadStudentsFromFiles();
+    loadCredentials();
+    loadComplaints();
+    loadHistory();
+    loadResults();
+    // the first copy is made here, so no reader ever waits for a writer to get one
+    ensureRankIndex();
+    shared_lock<shared_mutex> lk(storeMutex);
+    atomic_store(&publishedResults, copyResults());
+}
+
+void mainMenu() {
+    loadAll();
+    while (true) {
+        cout << "\n============================\n";
+        cout << "     STUDENT RECORD SYSTEM\n";
         cout << "============================\n";
         cout << "1. Admin Login\n2. Student Login\n3. Parent Login\n4. Exit\n";
         cout << "Enter choice: ";
@@ -529,7 +4604,7 @@ void mainMenu() {
             // admin menu
             while (true) {
                 cout << "\n--- ADMIN MENU ---\n";
-                cout << "1. Add Student\n2. View Students\n3. Delete Student\n4. Update Marks\n5. View Complaints\n6. Solve Complaint\n7. Change Admin Password\n8. Logout\nEnter choice: ";
+                cout << "1. Add Student\n2. View Students\n3. Delete Student\n4. Update Marks\n5. View Complaints\n6. Solve Complaint\n7. Change Admin Password\n8. Compact Data Files\n9. Class Report\n10. Import Students (CSV)\n11. Export Students (CSV)\n12. Search Students\n13. Metrics Report\n14. Write Metrics (Prometheus)\n15. Memory Report\n16. Report Cards\n17. Term History\n18. Results Draft\n19. Logout\nEnter choice: ";
                 int a; cin >> a;
                 if (a == 1) addStudent();
                 else if (a == 2) viewStudents();
@@ -538,6 +4613,17 @@ void mainMenu() {
                 else if (a == 5) viewComplaints();
                 else if (a == 6) solveComplaint();
                 else if (a == 7) changeAdminPassword();
+                else if (a == 8) { compactDataFiles(); cout << "✔ Data files compacted.\n"; }
+                else if (a == 9) classReport();
+                else if (a == 10) importStudentsPrompt();
+                else if (a == 11) exportStudentsPrompt();
+                else if (a == 12) searchStudents();
+                else if (a == 13) metricsReport();
+                else if (a == 14) writeMetricsPrompt();
+                else if (a == 15) memoryReport();
+                else if (a == 16) reportCardsPrompt();
+                else if (a == 17) termHistoryMenu();
+                else if (a == 18) resultsMenu();
                 else break;
             }
         }
@@ -546,11 +4632,12 @@ void mainMenu() {
             if (!studentLogin(roll)) { cout << "❌ Invalid student credentials!\n"; continue; }
             while (true) {
                 cout << "\n--- STUDENT MENU ---\n";
-                cout << "1. View My Details\n2. Raise Complaint\n3. Change Password\n4. Logout\nChoice: ";
+                cout << "1. View My Details\n2. Raise Complaint\n3. Change Password\n4. Marks History\n5. Logout\nChoice: ";
                 int s; cin >> s;
                 if (s == 1) studentView(roll);
                 else if (s == 2) raiseComplaintWithConfirm(roll);
-                else if (s == 3) changePasswordInFile("student_login.txt", roll);
+                else if (s == 3) changePassword('S', roll);
+                else if (s == 4) printMarksHistory(roll, -1);
                 else break;
             }
         }
@@ -559,14 +4646,16 @@ void mainMenu() {
             if (!parentLogin(roll)) { cout << "❌ Invalid parent credentials!\n"; continue; }
             while (true) {
                 cout << "\n--- PARENT MENU ---\n";
-                cout << "1. View Child Details\n2. Change Password\n3. Logout\nChoice: ";
+                cout << "1. View Child Details\n2. Change Password\n3. Marks History\n4. Logout\nChoice: ";
                 int p; cin >> p;
                 if (p == 1) parentView(roll);
-                else if (p == 2) changePasswordInFile("parent_login.txt", roll);
+                else if (p == 2) changePassword('P', roll);
+                else if (p == 3) printMarksHistory(roll, -1);
                 else break;
             }
         }
         else if (c == 4) {
+            if (journalRecords > 0) compactDataFiles();
             cout << "Goodbye!\n";
             break;
         }
@@ -574,7 +4663,1028 @@ void mainMenu() {
     }
 }
 
-int main() {
+// -------------------- Batch mode --------------------
+/*
+  srms --batch [file]  reads one command per line (stdin when no file or "-"):
+    add|roll|name|parentName|mobile|m1,m2,...   (one mark per subject, in schema order)
+    delete|roll
+    update-marks|roll|m1,m2,...             or  update-marks|roll|Subject|mark
+    view|roll
+    complaint-raise|roll|text[|high|normal|low]
+    complaint-solve|roll                  (resolves every open ticket of the roll)
+    complaint-resolve|ticketId
+    complaint-queue[|oldest|priority][|limit]
+    login|student|roll|password             (role student or parent)
+    password|student|roll|oldPassword|newPassword
+    find-name|prefix    find-parent|prefix    find-mobile|digits    find-marks|Subject|low|high
+    draft-marks|roll|Subject|mark    draft-publish    draft-discard   (see Published results)
+  Blank lines and lines starting with # are ignored. Each command prints one JSON
+  line; data is loaded once and persisted once when the batch ends. draft-marks and
+  draft-publish write at once, as they do from the menu.
+*/
+string jsonString(const string &s) {
+    string out = "\"";
+    for (char c : s) {
+        if (c == '"' || c == '\\') { out += '\\'; out += c; }
+        else if ((unsigned char)c < 0x20) { char buf[8]; snprintf(buf, sizeof(buf), "\\u%04x", c); out += buf; }
+        else out += c;
+    }
+    return out + "\"";
+}
+
+string jsonNumber(float v) {
+    string out;
+    appendFloat(out, v);
+    return out;
+}
+
+string ticketJson(const Ticket &t) {
+    string out = "{\"id\":" + to_string(t.id) + ",\"roll\":" + to_string(t.roll)
+        + ",\"priority\":" + jsonString(PRIORITY_NAMES[t.priority]) + ",\"status\":" + jsonString(t.isOpen() ? "open" : "resolved")
+        + ",\"openedAt\":" + to_string(t.openedAt);
+    if (!t.isOpen()) out += ",\"resolvedAt\":" + to_string(t.resolvedAt);
+    return out + ",\"text\":" + jsonString(t.text) + "}";
+}
+
+string studentJson(const Student &st) {
+    string out = "{\"roll\":" + to_string(st.roll) + ",\"name\":" + jsonString(st.name)
+        + ",\"parentName\":" + jsonString(st.parentName) + ",\"parentMobile\":" + jsonString(st.parentMobile)
+        + ",\"marks\":{";
+    for (int i = 0; i < numSubjects; ++i) out += (i ? "," : "") + jsonString(subjectNames[i]) + ":" + jsonNumber(st.marks[i]);
+    out += "},\"complaints\":[";
+    vector<Ticket> history = ticketsForRoll(st.roll);
+    for (size_t i = 0; i < history.size(); ++i) out += (i ? "," : "") + ticketJson(history[i]);
+    return out + "]}";
+}
+
+bool parseRollField(const string &s, int &roll) {
+    string r = trim(s);
+    if (!isDigits(r)) return false;
+    return from_chars(r.data(), r.data() + r.size(), roll).ec == errc();
+}
+
+bool parseRoleField(const string &s, char &role) {
+    string r = trim(s);
+    if (r == "student") role = 'S';
+    else if (r == "parent") role = 'P';
+    else return false;
+    return true;
+}
+
+// find-name, find-parent, find-mobile and find-marks; the matches as JSON fields
+bool runFindCommand(const string &cmd, const vector<string> &f, string &fields, string &err) {
+    vector<Student> found;
+    if (cmd == "find-name" || cmd == "find-parent") {
+        if (f.size() != 2 || trim(f[1]).empty()) { err = "usage: " + cmd + "|prefix"; return false; }
+        found = searchByNamePrefix(trim(f[1]), cmd == "find-parent");
+    } else if (cmd == "find-mobile") {
+        if (f.size() != 2 || !isDigits(trim(f[1]))) { err = "usage: find-mobile|digits"; return false; }
+        found = searchByMobile(trim(f[1]));
+    } else {
+        float lo, hi;
+        if (f.size() != 4) { err = "usage: find-marks|Subject|low|high"; return false; }
+        auto it = find(subjectNames.begin(), subjectNames.end(), trim(f[1]));
+        if (it == subjectNames.end()) { err = "unknown subject"; return false; }
+        if (!parseFloatView(trimView(f[2]), lo) || !parseFloatView(trimView(f[3]), hi) || lo > hi) { err = "invalid range"; return false; }
+        found = searchByMarks((int)(it - subjectNames.begin()), lo, hi);
+    }
+    fields = ",\"count\":" + to_string(found.size()) + ",\"students\":[";
+    for (size_t i = 0; i < found.size(); ++i) fields += (i ? "," : "") + studentJson(found[i]);
+    fields += "]";
+    return true;
+}
+
+// "m1,m2,...": one number per subject, else false with err set
+bool parseBatchMarks(const string &field, float *marks, string &err) {
+    vector<string> m = split(field, ',');
+    if ((int)m.size() != numSubjects) { err = "expected " + to_string(numSubjects) + " marks"; return false; }
+    for (int i = 0; i < numSubjects; ++i)
+        if (!parseFloatView(trimView(m[i]), marks[i])) { err = "invalid marks"; return false; }
+    return true;
+}
+
+// commands that take a roll, checked before the roll field is read
+const set<string> ROLL_COMMANDS = {"add", "delete", "login", "password", "view", "update-marks", "draft-marks",
+                                   "complaint-raise", "complaint-solve"};
+
+// runs one command; returns the JSON fields after "ok" or sets err
+bool runBatchCommand(const vector<string> &f, string &fields, string &err) {
+    const string cmd = trim(f[0]);
+    if (cmd == "find-name" || cmd == "find-parent" || cmd == "find-mobile" || cmd == "find-marks")
+        return runFindCommand(cmd, f, fields, err);
+    if (cmd == "complaint-resolve") {
+        uint32_t id;
+        if (f.size() != 2 || !parseIntView(f[1], id)) { err = "usage: complaint-resolve|ticketId"; return false; }
+        if (!resolveTicket(id)) { err = "no open ticket with this id"; return false; }
+        return true;
+    }
+    if (cmd == "complaint-queue") {
+        string order = f.size() >= 2 ? trim(f[1]) : "oldest";
+        size_t limit = 20;
+        if ((order != "oldest" && order != "priority") || f.size() > 3 || (f.size() == 3 && !parseIntView(f[2], limit))) {
+            err = "usage: complaint-queue|oldest or priority|limit"; return false;
+        }
+        vector<Ticket> page = openTicketPage(order == "priority", 0, limit);
+        fields = ",\"open\":" + to_string(openTicketCount()) + ",\"tickets\":[";
+        for (size_t i = 0; i < page.size(); ++i) fields += (i ? "," : "") + ticketJson(page[i]);
+        fields += "]";
+        return true;
+    }
+    if (cmd == "draft-publish") {
+        size_t applied, skipped;
+        err = publishResults(applied, skipped);
+        if (!err.empty()) return false;
+        fields = ",\"applied\":" + to_string(applied) + ",\"skipped\":" + to_string(skipped);
+        return true;
+    }
+    if (cmd == "draft-discard") {
+        fields = ",\"discarded\":" + to_string(discardResultsDraft());
+        return true;
+    }
+    if (!ROLL_COMMANDS.count(cmd)) { err = "unknown command"; return false; }
+    int roll = 0;
+    size_t rollField = (cmd == "login" || cmd == "password") ? 2 : 1;
+    if (f.size() <= rollField || !parseRollField(f[rollField], roll)) { err = "missing or invalid roll"; return false; }
+    if (cmd == "add") {
+        if (f.size() != 6) { err = "usage: add|roll|name|parentName|mobile|marks"; return false; }
+        Student st;
+        if (!parseStudentLine(f[1] + "|" + f[2] + "|" + f[3] + "|" + f[4] + "|" + f[5] + "|", st)) { err = "malformed record"; return false; }
+        if (!parseBatchMarks(f[5], st.marks, err)) return false;
+        err = validateStudentFields(st);
+        if (!err.empty()) return false;
+        string sPass, pPass;
+        err = addStudentRecord(st, sPass, pPass);
+        if (!err.empty()) return false;
+        fields = ",\"studentPassword\":" + jsonString(sPass) + ",\"parentPassword\":" + jsonString(pPass);
+        return true;
+    }
+    if (cmd == "delete") {
+        if (!deleteStudentRecord(roll)) { err = "student not found"; return false; }
+        return true;
+    }
+    if (cmd == "login" || cmd == "password") {
+        char role;
+        if (!parseRoleField(f[1], role)) { err = "role must be student or parent"; return false; }
+        if (f.size() != (cmd == "login" ? 4u : 5u)) { err = "wrong number of fields"; return false; }
+        bool ok = checkCredential(role, roll, trim(f[3]));
+        if (cmd == "login") { fields = string(",\"authenticated\":") + (ok ? "true" : "false"); return true; }
+        if (!ok) { err = "old password incorrect"; return false; }
+        string newPass = trim(f[4]);
+        if (newPass.length() < 6 || newPass.find(' ') != string::npos) { err = "new password must be at least 6 characters without spaces"; return false; }
+        if (!setCredential(role, roll, newPass)) { err = "could not save the new password"; return false; }
+        return true;
+    }
+    if (cmd == "view") {
+        Student st;
+        if (!getStudent(roll, st)) { err = "student not found"; return false; }
+        fields = ",\"student\":" + studentJson(st);
+        return true;
+    }
+    if (cmd == "update-marks") {
+        float marks[MAX_SUBJECTS];
+        int first = 0, last = numSubjects;
+        if (f.size() == 3) {
+            if (!parseBatchMarks(f[2], marks, err)) return false;
+        } else if (f.size() == 4) {
+            auto it = find(subjectNames.begin(), subjectNames.end(), trim(f[2]));
+            if (it == subjectNames.end()) { err = "unknown subject"; return false; }
+            first = (int)(it - subjectNames.begin()); last = first + 1;
+            if (!parseFloatView(trimView(f[3]), marks[first])) { err = "invalid marks"; return false; }
+        } else { err = "usage: update-marks|roll|m1,...  or  update-marks|roll|Subject|mark"; return false; }
+        for (int i = first; i < last; ++i)
+            if (!(marks[i] >= 0 && marks[i] <= 100)) { err = "marks must be 0-100"; return false; }
+        if (!updateStudentMarks(roll, first, last, marks)) { err = "student not found"; return false; }
+        return true;
+    }
+    if (cmd == "draft-marks") {
+        float mark;
+        if (f.size() != 4) { err = "usage: draft-marks|roll|Subject|mark"; return false; }
+        if (!parseFloatView(trimView(f[3]), mark)) { err = "invalid marks"; return false; }
+        return stageMarks({{roll, trim(f[2]), mark}}, err);
+    }
+    if (cmd == "complaint-raise") {
+        string text = f.size() >= 3 ? trim(f[2]) : "";
+        if (text.empty() || f.size() > 4) { err = "complaint must be one non-empty field"; return false; }
+        int priority = PRIORITY_NORMAL;
+        if (f.size() == 4) {
+            string p = trim(f[3]);
+            priority = p == "high" ? PRIORITY_HIGH : p == "normal" ? PRIORITY_NORMAL : p == "low" ? PRIORITY_LOW : 0;
+            if (!priority) { err = "priority must be high, normal or low"; return false; }
+        }
+        uint32_t id;
+        if (!raiseComplaint(roll, text, priority, id)) { err = "student not found"; return false; }
+        fields = ",\"ticket\":" + to_string(id);
+        return true;
+    }
+    if (cmd == "complaint-solve") {
+        if (!rollExists(roll)) { err = "student not found"; return false; }
+        size_t n = resolveTicketsForRoll(roll);
+        if (!n) { err = "no complaint for this roll"; return false; }
+        fields = ",\"resolved\":" + to_string(n);
+        return true;
+    }
+    err = "unknown command";
+    return false;
+}
+
+struct BatchTally {
+    size_t ok = 0, failed = 0;
+};
+
+// runs one session's commands; output goes to sink in 64 KiB chunks
+void runBatchSession(istream &in, ostream &sink, int session, BatchTally &tally) {
+    string out, line;
+    string prefix = session >= 0 ? "{\"session\":" + to_string(session) + "," : "{";
+    size_t lineNo = 0;
+    while (getline(in, line)) {
+        ++lineNo;
+        line = trim(line);
+        if (line.empty() || line[0] == '#') continue;
+        vector<string> f = split(line, '|');
+        string fields, err;
+        bool ok = runBatchCommand(f, fields, err);
+        out += prefix + "\"line\":" + to_string(lineNo) + ",\"cmd\":" + jsonString(trim(f[0])) + ",\"ok\":" + (ok ? "true" : "false");
+        out += ok ? fields : ",\"error\":" + jsonString(err);
+        out += "}\n";
+        (ok ? tally.ok : tally.failed)++;
+        if (out.size() >= (1 << 16)) { sink << out; out.clear(); }
+    }
+    sink << out;
+}
+
+// one session per input; several inputs run concurrently on the worker pool
+int runBatch(const vector<string> &files) {
+    loadAll();
+    deferPersist = true;
+    auto t0 = chrono::steady_clock::now();
+    BatchTally total;
+    if (files.size() == 1) {
+        ifstream fin;
+        if (files[0] != "-") {
+            fin.open(files[0]);
+            if (!fin) { cout << "❌ Cannot open " << files[0] << ".\n"; return 1; }
+        }
+        runBatchSession(files[0] == "-" ? cin : fin, cout, -1, total);
+    } else {
+        vector<ostringstream> outputs(files.size());
+        vector<BatchTally> tallies(files.size());
+        {
+            WorkerPool pool(min<unsigned>(hardwareThreads(), (unsigned)files.size()));
+            for (size_t i = 0; i < files.size(); ++i) {
+                pool.submit([&, i] {
+                    ifstream fin(files[i]);
+                    if (!fin) { outputs[i] << "{\"session\":" << i << ",\"ok\":false,\"error\":" << jsonString("cannot open " + files[i]) << "}\n"; tallies[i].failed++; return; }
+                    runBatchSession(fin, outputs[i], (int)i, tallies[i]);
+                });
+            }
+            pool.wait();
+        }
+        for (size_t i = 0; i < files.size(); ++i) {
+            cout << outputs[i].str();
+            total.ok += tallies[i].ok; total.failed += tallies[i].failed;
+        }
+    }
+    flushPersistence();
+    double sec = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+    size_t commands = total.ok + total.failed;
+    cout << "{\"summary\":{\"sessions\":" << files.size() << ",\"commands\":" << commands << ",\"ok\":" << total.ok
+         << ",\"failed\":" << total.failed << ",\"seconds\":" << to_string(sec)
+         << ",\"commandsPerSecond\":" << (sec > 0 ? (size_t)(commands / sec) : 0) << "}}\n" << flush;
+    return total.failed == 0 ? 0 : 2;
+}
+
+// -------------------- Stress test --------------------
+/*
+  srms --stress [threads] [seconds]: in-memory only, nothing is written to disk.
+  Writers keep setting every mark of a student to one value v and its name to
+  "v<v>", and keep deleting and re-adding students. Readers check that each copy
+  they get, from the store or from the published results, has equal marks matching
+  its name, and that markColumns agree with the records. Any mismatch is a torn
+  record.
+*/
+int runStress(unsigned threads, double seconds) {
+    const int ROSTER = 10000;
+    deferPersist = true; // never flushed: the stress run does not touch the data files
+    hashIterations = 1;  // exercises the store, not the key derivation
+    {
+        unique_lock<shared_mutex> lk(storeMutex);
+        clearStudents();
+        Student st;
+        for (int r = 1; r <= ROSTER; ++r) {
+            st.roll = r; st.parentName = "Stress Parent"; st.parentMobile = "9000000000";
+            for (int i = 0; i < numSubjects; ++i) st.marks[i] = 0;
+            st.name = "v0";
+            insertStudent(st);
+        }
+    }
+    threads = max(2u, threads);
+    unsigned writers = max(1u, threads / 4);
+    atomic<bool> stop{false};
+    atomic<size_t> reads{0}, writes{0}, torn{0};
+    auto consistent = [](const Student &st) {
+        for (int i = 1; i < numSubjects; ++i) if (st.marks[i] != st.marks[0]) return false;
+        return st.name == "v" + to_string((int)st.marks[0]);
+    };
+    vector<thread> pool;
+    for (unsigned t = 0; t < threads; ++t) {
+        bool writer = t < writers;
+        pool.emplace_back([&, writer, t] {
+            mt19937 rng(1234 + t);
+            uniform_int_distribution<int> rollDist(1, ROSTER), markDist(0, 100);
+            size_t n = 0;
+            while (!stop.load(memory_order_relaxed)) {
+                int roll = rollDist(rng);
+                if (writer) {
+                    float v = (float)markDist(rng);
+                    if (n % 16 == 15) {
+                        Student st;
+                        if (getStudent(roll, st) && deleteStudentRecord(roll)) {
+                            for (int i = 0; i < numSubjects; ++i) st.marks[i] = v;
+                            st.name = "v" + to_string((int)v);
+                            string sp, pp;
+                            addStudentRecord(st, sp, pp);
+                        }
+                    } else {
+                        unique_lock<shared_mutex> lk(storeMutex);
+                        size_t pos = findPos(roll);
+                        if (pos != NO_POS) {
+                            Student st = studentAt(pos);
+                            for (int i = 0; i < numSubjects; ++i) st.marks[i] = v;
+                            st.name = "v" + to_string((int)v);
+                            putStudent(st);
+                        }
+                    }
+                    ++writes;
+                } else if (n % 64 == 63) {
+                    shared_lock<shared_mutex> lk(storeMutex);
+                    for (size_t pos = 0; pos < students.size(); pos += 97) {
+                        float m0 = markColumns[0][pos];
+                        bool ok = nameOf(students[pos]) == "v" + to_string((int)m0);
+                        for (int i = 1; i < numSubjects && ok; ++i) ok = markColumns[i][pos] == m0;
+                        if (!ok) ++torn;
+                    }
+                    ++reads;
+                } else if (n % 4 == 1) {
+                    Student st;
+                    Rank ranks[MAX_SUBJECTS], total;
+                    if (publishedStudent(roll, st, ranks, total) && !consistent(st)) ++torn;
+                    ++reads;
+                } else {
+                    Student st;
+                    if (getStudent(roll, st) && !consistent(st)) ++torn;
+                    ++reads;
+                }
+                ++n;
+            }
+        });
+    }
+    this_thread::sleep_for(chrono::duration<double>(seconds));
+    stop = true;
+    for (auto &t : pool) t.join();
+    cout << "{\"threads\":" << threads << ",\"writers\":" << writers << ",\"seconds\":" << seconds
+         << ",\"reads\":" << reads << ",\"writes\":" << writes << ",\"readsPerSecond\":" << (size_t)(reads / seconds)
+         << ",\"writesPerSecond\":" << (size_t)(writes / seconds) << ",\"torn\":" << torn << "}\n";
+    cout << (torn == 0 ? "✔ No torn records.\n" : "❌ Torn records detected!\n");
+    return torn == 0 ? 0 : 1;
+}
+
+// -------------------- Roster generator & benchmarks --------------------
+/*
+  srms --generate <rows> [dir] [subjects]
+                                writes a deterministic students.txt, student_login.txt,
+                                parent_login.txt (and admin_login.txt if missing) into dir,
+                                with the default subjects or the given "A,B,..." list.
+  srms --bench [rows ...]       generates each size (default 10000 100000 1000000) in a
+                                temporary directory and prints one JSON document with the
+                                timings of the load, save, login, password, delete and lookup paths.
+*/
+// xorshift64: same sequence on every platform, unlike the <random> distributions
+struct DetRng {
+    uint64_t x;
+    explicit DetRng(uint64_t seed) : x(seed ? seed : 1) {}
+    uint64_t next() { x ^= x << 13; x ^= x >> 7; x ^= x << 17; return x; }
+    uint32_t below(uint32_t n) { return (uint32_t)(next() % n); }
+};
+
+// first SRMS data file found in dir, or "" when there is none
+string existingDataFile(const string &dir) {
+    static const string files[] = {STUDENTS_FILE, BINARY_FILE, SHARD_DIR, JOURNAL_FILE, STUDENT_LOGIN_FILE,
+                                   PARENT_LOGIN_FILE, ADMIN_LOGIN_FILE, COMPLAINT_LOG, COMPLAINTS_FILE,
+                                   HISTORY_FILE, RESULTS_DRAFT_FILE, RESULTS_PUBLISH_FILE};
+    error_code ec;
+    for (auto &f : files)
+        if (filesystem::exists(filesystem::path(dir) / f, ec)) return f;
+    return "";
+}
+
+bool generateRoster(size_t rows, const string &dir) {
+    static const char *first[] = {"Rohan", "Anita", "Vikram", "Meera", "Arjun", "Kavya", "Sanjay", "Priya",
+                                  "Rahul", "Divya", "Amit", "Neha", "Karan", "Sneha", "Manoj", "Pooja"};
+    static const char *last[] = {"Kumar", "Sharma", "Singh", "Nair", "Reddy", "Iyer", "Patel", "Das",
+                                 "Gupta", "Rao", "Menon", "Joshi", "Verma", "Pillai", "Bose", "Shah"};
+    error_code ec;
+    filesystem::create_directories(dir, ec);
+    DetRng rng(20240601);
+    // synthetic accounts: generatePassword() passwords hashed with one iteration and
+    // salts from a fixed seed, so large rosters generate quickly and identically
+    DetRng saltRng(0x9e3779b97f4a7c15ULL);
+    auto hashed = [&](const string &password) {
+        uint8_t salt[16];
+        for (int k = 0; k < 16; k += 8) { uint64_t v = saltRng.next(); memcpy(salt + k, &v, 8); }
+        return encodePasswordHash(hashPassword(password, 1, salt));
+    };
+    string sOut = subjectsHeaderLine(), sLogin, pLogin, cLog;
+    sOut.reserve(rows * 64);
+    uint32_t ticketId = 0;
+    Student st;
+    for (size_t i = 1; i <= rows; ++i) {
+        st.roll = (int)i;
+        st.name = string(first[rng.below(16)]) + " " + last[rng.below(16)];
+        st.parentName = string(first[rng.below(16)]) + " " + st.name.substr(st.name.find(' ') + 1);
+        st.parentMobile = to_string(9000000000ULL + rng.below(1000000000));
+        for (int m = 0; m < numSubjects; ++m) st.marks[m] = (float)(20 + rng.below(81));
+        if (rng.below(50) == 0) {
+            // fixed timestamps keep the output identical between runs
+            cLog += "O|" + to_string(++ticketId) + "|" + to_string(st.roll) + "|" + to_string(1 + (int)(i % 3))
+                  + "|" + to_string(1700000000 + i) + "|Need rechecking\n";
+        }
+        sOut += formatStudentLine(st) + "\n";
+        sLogin += to_string(st.roll) + "|" + hashed(generatePassword(st.name, st.roll, 'S')) + "\n";
+        pLogin += to_string(st.roll) + "|" + hashed(generatePassword(st.parentName, st.roll, 'P')) + "\n";
+    }
+    filesystem::path d(dir);
+    bool ok = writeFileAtomic((d / STUDENTS_FILE).string(), sOut)
+           && writeFileAtomic((d / STUDENT_LOGIN_FILE).string(), sLogin)
+           && writeFileAtomic((d / PARENT_LOGIN_FILE).string(), pLogin)
+           && writeFileAtomic((d / COMPLAINT_LOG).string(), cLog);
+    if (!filesystem::exists(d / "admin_login.txt")) ok = ok && writeFileAtomic((d / "admin_login.txt").string(), "admin 12345a\n");
+    return ok;
+}
+
+template <typename Fn>
+double timeMs(Fn fn) {
+    auto t0 = chrono::steady_clock::now();
+    fn();
+    return chrono::duration<double, milli>(chrono::steady_clock::now() - t0).count();
+}
+
+// one benchmark result as a JSON object
+string benchJson(const string &name, size_t rows, size_t ops, double ms) {
+    ostringstream out;
+    out << "{\"name\":" << jsonString(name) << ",\"rows\":" << rows << ",\"ops\":" << ops << ",\"ms\":" << ms
+        << ",\"opsPerSecond\":" << (ms > 0 ? (size_t)(ops * 1000.0 / ms) : 0) << "}";
+    return out.str();
+}
+
+// runs in the current directory against freshly generated files
+vector<string> benchRoster(size_t rows) {
+    vector<string> out;
+    DetRng rng(7);
+    const size_t LOOKUPS = 1000000, DURABLE_OPS = 200;
+    deferPersist = false;
+    journalMode = true;
+
+    vector<Student> legacy;
+    out.push_back(benchJson("load_legacy_getline_split", rows, 1, timeMs([&] { loadStudentsLegacy(STUDENTS_FILE, legacy); })));
+    legacy.clear(); legacy.shrink_to_fit();
+    out.push_back(benchJson("load_students", rows, 1, timeMs([] { loadStudentsFromFiles(); })));
+    out.push_back(benchJson("load_credentials", rows, 1, timeMs([] { loadCredentials(); })));
+    out.push_back(benchJson("save_students", rows, 1, timeMs([] { compactDataFiles(); })));
+
+    vector<pair<int,string>> logins;
+    for (int i = 0; i < 1000; ++i) {
+        int roll = 1 + (int)rng.below((uint32_t)rows);
+        Student st;
+        getStudent(roll, st);
+        logins.push_back({roll, generatePassword(st.name, roll, 'S')});
+    }
+    size_t hits = 0;
+    out.push_back(benchJson("login_check", rows, LOOKUPS, timeMs([&] {
+        for (size_t i = 0; i < LOOKUPS; ++i) hits += checkCredential('S', logins[i % logins.size()].first, logins[i % logins.size()].second);
+    })));
+    out.push_back(benchJson("lookup_by_roll", rows, LOOKUPS, timeMs([&] {
+        Student st;
+        for (size_t i = 0; i < LOOKUPS; ++i) hits += getStudent(1 + (int)rng.below((uint32_t)rows), st);
+    })));
+    const size_t SEARCHES = 1000;
+    out.push_back(benchJson("build_secondary_indexes", rows, 1, timeMs([] { ensureSecondaryIndexes(); })));
+    out.push_back(benchJson("build_rank_index", rows, 1, timeMs([] { ensureRankIndex(); })));
+    out.push_back(benchJson("rank_lookup", rows, SEARCHES, timeMs([&] {
+        Rank subjects[MAX_SUBJECTS], total;
+        for (size_t i = 0; i < SEARCHES; ++i) hits += studentRanks(1 + (int)rng.below((uint32_t)rows), subjects, total);
+    })));
+    // the same marks closed as eight terms, then one subject's trend over all of them
+    const size_t TERMS = 8;
+    loadHistory();
+    out.push_back(benchJson("close_term", rows, TERMS, timeMs([&] {
+        size_t count, bytes;
+        for (size_t i = 0; i < TERMS; ++i) hits += closeTermRecord("T" + to_string(i + 1), count, bytes).empty();
+    })));
+    out.push_back(benchJson("term_trend", rows, SEARCHES, timeMs([&] {
+        for (size_t i = 0; i < SEARCHES; ++i) hits += marksHistory(1 + (int)rng.below((uint32_t)rows), (int)(i % numSubjects)).size();
+    })));
+    out.push_back(benchJson("search_marks_range", rows, SEARCHES, timeMs([&] {
+        for (size_t i = 0; i < SEARCHES; ++i) { float lo = (float)rng.below(100); hits += searchByMarks((int)(i % numSubjects), lo, lo + 0.5f).size(); }
+    })));
+    out.push_back(benchJson("search_mobile", rows, SEARCHES, timeMs([&] {
+        for (size_t i = 0; i < SEARCHES; ++i) hits += searchByMobile(to_string(9000000000ULL + rng.below(1000000000))).size();
+    })));
+    out.push_back(benchJson("hash_password", rows, DURABLE_OPS / 10, timeMs([&] {
+        for (size_t i = 0; i < DURABLE_OPS / 10; ++i) hits += hashPassword("newpass" + to_string(i)).iterations > 0;
+    })));
+    out.push_back(benchJson("change_password", rows, DURABLE_OPS, timeMs([&] {
+        for (size_t i = 0; i < DURABLE_OPS; ++i) setCredential('S', logins[i].first, "newpass" + to_string(i));
+    })));
+    float marks[MAX_SUBJECTS];
+    for (int i = 0; i < numSubjects; ++i) marks[i] = (float)(50 + 10 * (i % 5));
+    out.push_back(benchJson("update_marks", rows, DURABLE_OPS, timeMs([&] {
+        for (size_t i = 0; i < DURABLE_OPS; ++i) updateStudentMarks(1 + (int)rng.below((uint32_t)rows), 0, numSubjects, marks);
+    })));
+    // results day: one subject staged for the whole roster, published at once, then read
+    // back through the published results the portals use
+    vector<StagedMark> staged;
+    staged.reserve(rows);
+    for (size_t r = 1; r <= rows; ++r) staged.push_back({(int)r, subjectNames[0], (float)(r % 101)});
+    out.push_back(benchJson("stage_results", rows, rows, timeMs([&] { string err; hits += stageMarks(staged, err); })));
+    staged.clear(); staged.shrink_to_fit();
+    out.push_back(benchJson("publish_results", rows, rows, timeMs([&] { size_t applied, skipped; hits += publishResults(applied, skipped).empty(); })));
+    out.push_back(benchJson("published_lookup", rows, LOOKUPS, timeMs([&] {
+        Student st;
+        Rank ranks[MAX_SUBJECTS], total;
+        for (size_t i = 0; i < LOOKUPS; ++i) hits += publishedStudent(1 + (int)rng.below((uint32_t)rows), st, ranks, total);
+    })));
+    out.push_back(benchJson("delete_student", rows, DURABLE_OPS, timeMs([&] {
+        for (size_t i = 0; i < DURABLE_OPS; ++i) deleteStudentRecord((int)(rows - i));
+    })));
+    out.push_back(benchJson("compact_after_writes", rows, 1, timeMs([] { compactDataFiles(); })));
+
+    // same roster split into roll-range shards: parallel load, one shard rewritten per update
+    writeShards(DEFAULT_ROLLS_PER_SHARD);
+    out.push_back(benchJson("load_sharded", rows, 1, timeMs([] { loadStudentsFromFiles(); })));
+    out.push_back(benchJson("update_marks_sharded", rows, DURABLE_OPS, timeMs([&] {
+        for (size_t i = 0; i < DURABLE_OPS; ++i) updateStudentMarks(1 + (int)rng.below((uint32_t)rows), 0, numSubjects, marks);
+    })));
+    if (hits == 0) cerr << "warning: no lookups hit\n";
+    return out;
+}
+
+int runBenchmarks(vector<size_t> sizes) {
+    if (sizes.empty()) sizes = {10000, 100000, 1000000};
+    filesystem::path home = filesystem::current_path();
+    string json = "{\"benchmarks\":[";
+    bool firstRow = true;
+    for (size_t rows : sizes) {
+        filesystem::path dir = filesystem::temp_directory_path() / ("srms-bench-" + to_string(rows));
+        // leaves the temporary roster behind on no path, including an exception
+        struct BenchDir {
+            filesystem::path home, dir;
+            ~BenchDir() { error_code ec; filesystem::current_path(home, ec); filesystem::remove_all(dir, ec); }
+        } cleanup{home, dir};
+        error_code ec;
+        filesystem::remove_all(dir, ec);
+        cerr << "generating " << rows << " rows in " << dir.string() << "\n";
+        bool generated = false;
+        double genMs = timeMs([&] { generated = generateRoster(rows, dir.string()); });
+        if (!generated) { cout << "❌ Could not write to " << dir.string() << ".\n"; return 1; }
+        filesystem::current_path(dir);
+        vector<string> results = benchRoster(rows);
+        results.insert(results.begin(), benchJson("generate", rows, rows, genMs));
+        for (auto &r : results) { json += (firstRow ? "\n  " : ",\n  ") + r; firstRow = false; }
+    }
+    json += "\n],\"simd\":" + jsonString(hasAvx2() ? "avx2" : "scalar") + ",\"threads\":" + to_string(hardwareThreads()) + "}\n";
+    cout << json;
+    return 0;
+}
+
+// -------------------- Query server --------------------
+/*
+  srms --serve [port] [address]   (default 8080 on 127.0.0.1)
+    GET /student/<roll>   Authorization: Basic base64(<roll>:<student password>)
+    GET /parent/<roll>    Authorization: Basic base64(<roll>:<parent password>)
+    GET /health
+  Answers JSON straight from the in-memory store. HTTP/1.1 keep-alive and
+  pipelined requests are supported. One epoll loop per hardware thread shares
+  the listening socket (EPOLLEXCLUSIVE). Data is loaded once; the server is read-only.
+
+  srms --loadgen [port] [connections] [requests] [pipeline]
+    Replays parent lookups for random students of a generated roster (passwords
+    derived as --generate writes them) over loopback and reports requests/s and
+    p50/p99 latency.
+*/
+#ifdef SRMS_SERVER
+atomic<bool> serverStopping{false};
+
+string httpResponse(int status, const string &body, bool keepAlive, const char *contentType = "application/json") {
+    const char *reason = status == 200 ? "OK" : status == 400 ? "Bad Request" : status == 401 ? "Unauthorized"
+                       : status == 404 ? "Not Found" : status == 405 ? "Method Not Allowed" : status == 413 ? "Payload Too Large"
+                       : "Request Header Fields Too Large";
+    string out = "HTTP/1.1 " + to_string(status) + " " + reason + "\r\nContent-Type: " + contentType + "\r\nContent-Length: "
+               + to_string(body.size()) + "\r\nConnection: " + (keepAlive ? "keep-alive" : "close") + "\r\n";
+    if (status == 401) out += "WWW-Authenticate: Basic realm=\"srms\"\r\n";
+    return out + "\r\n" + body;
+}
+
+string jsonError(const string &msg) { return "{\"error\":" + jsonString(msg) + "}"; }
+
+// case-insensitive header lookup in the raw header block
+string_view headerValue(string_view headers, string_view name) {
+    size_t pos = 0;
+    while ((pos = headers.find("\r\n", pos)) != string_view::npos) {
+        pos += 2;
+        size_t colon = headers.find(':', pos), eol = headers.find("\r\n", pos);
+        if (colon == string_view::npos || (eol != string_view::npos && colon > eol)) continue;
+        string_view key = headers.substr(pos, colon - pos);
+        if (key.size() == name.size() && equal(key.begin(), key.end(), name.begin(),
+                [](char a, char b) { return tolower((unsigned char)a) == tolower((unsigned char)b); }))
+            return trimView(headers.substr(colon + 1, (eol == string_view::npos ? headers.size() : eol) - colon - 1));
+    }
+    return {};
+}
+
+// builds the response for one complete request head
+string handleHttpRequest(string_view head, bool &keepAlive) {
+    MetricTimer timer(OP_HTTP_REQUEST);
+    size_t lineEnd = head.find("\r\n");
+    string_view reqLine = head.substr(0, lineEnd);
+    size_t sp1 = reqLine.find(' '), sp2 = reqLine.rfind(' ');
+    if (sp1 == string_view::npos || sp2 <= sp1) { keepAlive = false; return httpResponse(400, jsonError("bad request line"), false); }
+    string_view method = reqLine.substr(0, sp1), path = reqLine.substr(sp1 + 1, sp2 - sp1 - 1), version = reqLine.substr(sp2 + 1);
+    string_view conn = headerValue(head, "Connection");
+    keepAlive = version == "HTTP/1.1" ? conn != "close" : conn == "keep-alive";
+    if (method != "GET") return httpResponse(405, jsonError("only GET is supported"), keepAlive);
+    if (path == "/health") {
+        size_t n;
+        { shared_lock<shared_mutex> lk(storeMutex); n = students.size(); }
+        return httpResponse(200, "{\"status\":\"ok\",\"students\":" + to_string(n) + "}", keepAlive);
+    }
+    if (path == "/metrics") return httpResponse(200, prometheusMetrics(), keepAlive, "text/plain; version=0.0.4");
+    char role;
+    string_view rollStr;
+    if (path.rfind("/student/", 0) == 0) { role = 'S'; rollStr = path.substr(9); }
+    else if (path.rfind("/parent/", 0) == 0) { role = 'P'; rollStr = path.substr(8); }
+    else return httpResponse(404, jsonError("unknown path"), keepAlive);
+    int roll;
+    if (!isDigitsView(rollStr) || from_chars(rollStr.data(), rollStr.data() + rollStr.size(), roll).ec != errc())
+        return httpResponse(400, jsonError("invalid roll"), keepAlive);
+    string_view auth = headerValue(head, "Authorization");
+    string cred;
+    if (auth.rfind("Basic ", 0) != 0 || !base64Decode(trimView(auth.substr(6)), cred))
+        return httpResponse(401, jsonError("missing credentials"), keepAlive);
+    size_t colon = cred.find(':');
+    if (colon == string::npos || cred.compare(0, colon, rollStr.data(), rollStr.size()) != 0
+        || !checkCredential(role, roll, cred.substr(colon + 1)))
+        return httpResponse(401, jsonError("invalid credentials"), keepAlive);
+    Student st;
+    Rank ranks[MAX_SUBJECTS], total;
+    if (!publishedStudent(roll, st, ranks, total)) return httpResponse(404, jsonError("student not found"), keepAlive);
+    return httpResponse(200, studentJson(st), keepAlive);
+}
+
+struct HttpConnection {
+    string in, out;
+    size_t outPos = 0;
+    bool closeAfterWrite = false;
+};
+
+// consumes every complete request in c.in (pipelining) and queues the responses in order
+void processHttpInput(HttpConnection &c) {
+    const size_t MAX_HEAD = 8192;
+    size_t start = 0;
+    while (!c.closeAfterWrite) {
+        size_t end = c.in.find("\r\n\r\n", start);
+        if (end == string::npos) {
+            if (c.in.size() - start > MAX_HEAD) { c.out += httpResponse(431, jsonError("request head too large"), false); c.closeAfterWrite = true; }
+            break;
+        }
+        string_view head(c.in.data() + start, end - start + 2);
+        size_t next = end + 4;
+        string_view len = headerValue(head, "Content-Length");
+        size_t bodyLen = 0;
+        if (!len.empty()) {
+            // every route is a GET: a body is only skipped, and never more than MAX_HEAD bytes of it
+            auto r = from_chars(len.data(), len.data() + len.size(), bodyLen);
+            if (r.ec != errc() || r.ptr != len.data() + len.size()) {
+                c.out += httpResponse(400, jsonError("invalid Content-Length"), false); c.closeAfterWrite = true; break;
+            }
+            if (bodyLen > MAX_HEAD) { c.out += httpResponse(413, jsonError("request body too large"), false); c.closeAfterWrite = true; break; }
+        }
+        if (c.in.size() - next < bodyLen) break; // body still arriving; ignored once complete
+        bool keepAlive = true;
+        c.out += handleHttpRequest(head, keepAlive);
+        if (!keepAlive) c.closeAfterWrite = true;
+        start = next + bodyLen;
+    }
+    c.in.erase(0, start);
+}
+
+void setNonBlocking(int fd) { fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK); }
+
+void serverLoop(int listenFd) {
+    int ep = epoll_create1(0);
+    epoll_event ev{};
+    ev.events = EPOLLIN | EPOLLEXCLUSIVE;
+    ev.data.fd = listenFd;
+    epoll_ctl(ep, EPOLL_CTL_ADD, listenFd, &ev);
+    unordered_map<int, HttpConnection> conns;
+    vector<epoll_event> events(256);
+    char buf[16384];
+    auto closeConn = [&](int fd) { epoll_ctl(ep, EPOLL_CTL_DEL, fd, nullptr); close(fd); conns.erase(fd); };
+    auto flushConn = [&](int fd, HttpConnection &c) {
+        while (c.outPos < c.out.size()) {
+            ssize_t n = send(fd, c.out.data() + c.outPos, c.out.size() - c.outPos, MSG_NOSIGNAL);
+            if (n < 0) {
+                if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+                closeConn(fd); return;
+            }
+            c.outPos += (size_t)n;
+        }
+        bool pending = c.outPos < c.out.size();
+        if (!pending) {
+            c.out.clear(); c.outPos = 0;
+            if (c.closeAfterWrite) { closeConn(fd); return; }
+        }
+        epoll_event mod{};
+        mod.events = EPOLLIN | EPOLLRDHUP | (pending ? (uint32_t)EPOLLOUT : 0u);
+        mod.data.fd = fd;
+        epoll_ctl(ep, EPOLL_CTL_MOD, fd, &mod);
+    };
+    while (!serverStopping) {
+        int n = epoll_wait(ep, events.data(), (int)events.size(), 500);
+        for (int i = 0; i < n; ++i) {
+            int fd = events[i].data.fd;
+            if (fd == listenFd) {
+                while (true) {
+                    int cfd = accept(listenFd, nullptr, nullptr);
+                    if (cfd < 0) break;
+                    setNonBlocking(cfd);
+                    int one = 1;
+                    setsockopt(cfd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+                    epoll_event cev{};
+                    cev.events = EPOLLIN | EPOLLRDHUP;
+                    cev.data.fd = cfd;
+                    epoll_ctl(ep, EPOLL_CTL_ADD, cfd, &cev);
+                    conns[cfd];
+                }
+                continue;
+            }
+            auto it = conns.find(fd);
+            if (it == conns.end()) continue;
+            HttpConnection &c = it->second;
+            if (events[i].events & (EPOLLERR | EPOLLHUP)) { closeConn(fd); continue; }
+            if (events[i].events & EPOLLIN) {
+                bool peerClosed = false;
+                while (true) {
+                    ssize_t r = recv(fd, buf, sizeof(buf), 0);
+                    if (r > 0) { c.in.append(buf, (size_t)r); continue; }
+                    if (r == 0) peerClosed = true;
+                    else if (errno != EAGAIN && errno != EWOULDBLOCK) peerClosed = true;
+                    break;
+                }
+                processHttpInput(c);
+                if (peerClosed) c.closeAfterWrite = true;
+            }
+            flushConn(fd, c);
+        }
+    }
+    for (auto &kv : conns) close(kv.first);
+    close(ep);
+}
+
+int runServer(int port, const string &address) {
+    loadAll();
+    int listenFd = socket(AF_INET, SOCK_STREAM, 0);
+    if (listenFd < 0) { cout << "❌ Cannot create a socket: " << strerror(errno) << "\n"; return 1; }
+    int one = 1;
+    setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons((uint16_t)port);
+    if (inet_pton(AF_INET, address.c_str(), &addr.sin_addr) != 1) { cout << "❌ Invalid address " << address << ".\n"; return 1; }
+    if (bind(listenFd, (sockaddr *)&addr, sizeof(addr)) < 0 || listen(listenFd, 1024) < 0) {
+        cout << "❌ Cannot listen on " << address << ":" << port << ": " << strerror(errno) << "\n";
+        return 1;
+    }
+    setNonBlocking(listenFd);
+    signal(SIGINT, [](int) { serverStopping = true; });
+    signal(SIGTERM, [](int) { serverStopping = true; });
+    unsigned loops = hardwareThreads();
+    cout << "✔ Serving " << students.size() << " students on http://" << address << ":" << port
+         << " with " << loops << " event loops (Ctrl+C to stop)\n" << flush;
+    vector<thread> threads;
+    for (unsigned i = 0; i < loops; ++i) threads.emplace_back(serverLoop, listenFd);
+    for (auto &t : threads) t.join();
+    close(listenFd);
+    cout << "Server stopped.\n";
+    return 0;
+}
+
+// one blocking connection per thread; sends `pipeline` requests, then reads their responses
+int runLoadGenerator(int port, unsigned connections, size_t totalRequests, unsigned pipeline) {
+    loadAll();
+    // only hashes are stored, so the passwords are derived the way --generate writes them
+    vector<pair<int,string>> targets;
+    {
+        shared_lock<shared_mutex> lk(storeMutex);
+        for (auto &r : students) targets.push_back({r.roll, generatePassword(string(parentNameOf(r)), r.roll, 'P')});
+    }
+    if (targets.empty()) { cout << "❌ No students to look up.\n"; return 1; }
+    connections = max(1u, connections);
+    pipeline = max(1u, pipeline);
+    size_t perConn = max<size_t>(1, totalRequests / connections);
+    vector<vector<double>> latencies(connections);
+    atomic<size_t> errors{0};
+    auto t0 = chrono::steady_clock::now();
+    vector<thread> threads;
+    for (unsigned t = 0; t < connections; ++t) {
+        threads.emplace_back([&, t] {
+            int fd = socket(AF_INET, SOCK_STREAM, 0);
+            sockaddr_in addr{};
+            addr.sin_family = AF_INET;
+            addr.sin_port = htons((uint16_t)port);
+            inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+            if (connect(fd, (sockaddr *)&addr, sizeof(addr)) < 0) { errors += perConn; close(fd); return; }
+            int one = 1;
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+            mt19937 rng(99 + t);
+            string in;
+            char buf[65536];
+            latencies[t].reserve(perConn);
+            for (size_t done = 0; done < perConn;) {
+                unsigned batch = (unsigned)min<size_t>(pipeline, perConn - done);
+                string req;
+                for (unsigned b = 0; b < batch; ++b) {
+                    auto &tg = targets[rng() % targets.size()];
+                    req += "GET /parent/" + to_string(tg.first) + " HTTP/1.1\r\nHost: localhost\r\nAuthorization: Basic "
+                         + base64Encode(to_string(tg.first) + ":" + tg.second) + "\r\n\r\n";
+                }
+                auto sent = chrono::steady_clock::now();
+                if (send(fd, req.data(), req.size(), MSG_NOSIGNAL) != (ssize_t)req.size()) { errors += perConn - done; break; }
+                unsigned got = 0;
+                while (got < batch) {
+                    size_t end = in.find("\r\n\r\n");
+                    if (end != string::npos) {
+                        string_view len = headerValue(string_view(in).substr(0, end + 2), "Content-Length");
+                        size_t bodyLen = 0;
+                        from_chars(len.data(), len.data() + len.size(), bodyLen);
+                        if (in.size() >= end + 4 + bodyLen) {
+                            if (in.compare(0, 12, "HTTP/1.1 200") != 0) ++errors;
+                            latencies[t].push_back(chrono::duration<double, micro>(chrono::steady_clock::now() - sent).count());
+                            in.erase(0, end + 4 + bodyLen);
+                            ++got;
+                            continue;
+                        }
+                    }
+                    ssize_t r = recv(fd, buf, sizeof(buf), 0);
+                    if (r <= 0) break;
+                    in.append(buf, (size_t)r);
+                }
+                if (got < batch) { errors += perConn - done - got; break; }
+                done += batch;
+            }
+            close(fd);
+        });
+    }
+    for (auto &t : threads) t.join();
+    double sec = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+    vector<double> all;
+    for (auto &l : latencies) all.insert(all.end(), l.begin(), l.end());
+    sort(all.begin(), all.end());
+    auto pct = [&](double p) { return all.empty() ? 0.0 : all[min(all.size() - 1, (size_t)(p * all.size()))]; };
+    cout << "{\"connections\":" << connections << ",\"pipeline\":" << pipeline << ",\"requests\":" << all.size()
+         << ",\"errors\":" << errors << ",\"seconds\":" << sec << ",\"requestsPerSecond\":" << (size_t)(all.size() / sec)
+         << ",\"p50Micros\":" << pct(0.50) << ",\"p99Micros\":" << pct(0.99) << "}\n";
+    return errors == 0 ? 0 : 2;
+}
+#endif
+
+int main(int argc, char **argv) {
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        if (arg == "--no-journal") journalMode = false;
+        else if (arg == "--recover-text") recoverFromText = true;
+        else if (arg == "--hash-iterations" && i + 1 < argc) {
+            int n = atoi(argv[++i]);
+            if (n <= 0) { cout << "❌ Hash iterations must be a positive number.\n"; return 1; }
+            hashIterations = (uint32_t)n;
+        }
+        else if (arg == "--metrics-out" && i + 1 < argc) {
+            metricsOutFile = argv[++i];
+            atexit([] { if (!writeMetricsFile(metricsOutFile)) cerr << "❌ Cannot write " << metricsOutFile << ".\n"; });
+        }
+        else if (arg == "--report-cards" && i + 1 < argc) {
+            loadAll();
+            string format = i + 2 < argc ? argv[i + 2] : "text";
+            return writeReportCards(argv[i + 1], format == "html", i + 3 < argc ? argv[i + 3] : "") ? 0 : 1;
+        }
+        else if (arg == "--memory-report") { loadAll(); memoryReport(); return 0; }
+        else if (arg == "--set-subjects" && i + 1 < argc) { loadAll(); return changeSubjects(argv[i + 1]) ? 0 : 1; }
+        else if (arg == "--close-term" && i + 1 < argc) { loadAll(); return closeTerm(argv[i + 1]) ? 0 : 1; }
+        else if (arg == "--publish-results") {
+            loadAll();
+            size_t applied, skipped;
+            string err = publishResults(applied, skipped);
+            if (!err.empty()) { cout << "❌ " << err << ".\n"; return 1; }
+            cout << "✔ Published " << applied << " mark(s).\n";
+            if (skipped) cout << "⚠ " << skipped << " mark(s) skipped: student deleted or subject removed.\n";
+            return 0;
+        }
+        else if (arg == "--term-averages") { loadStudentsFromFiles(); loadHistory(); printTermAverages(); return 0; }
+        else if (arg == "--history" && i + 1 < argc) {
+            string roll = argv[i + 1];
+            if (!isDigits(roll)) { cout << "❌ Invalid roll input.\n"; return 1; }
+            loadStudentsFromFiles();
+            loadHistory();
+            int subject = -1;
+            if (i + 2 < argc) {
+                auto it = find(subjectNames.begin(), subjectNames.end(), string(argv[i + 2]));
+                if (it == subjectNames.end()) { cout << "❌ Unknown subject " << argv[i + 2] << ".\n"; return 1; }
+                subject = (int)(it - subjectNames.begin());
+            }
+            printMarksHistory(stoi(roll), subject);
+            return 0;
+        }
+        else if (arg == "--to-shards") {
+            int perShard = i + 1 < argc ? atoi(argv[i + 1]) : DEFAULT_ROLLS_PER_SHARD;
+            if (perShard <= 0) { cout << "❌ Rolls per shard must be a positive number.\n"; return 1; }
+            loadAll();
+            return convertToShards(perShard) ? 0 : 1;
+        }
+        else if (arg == "--to-binary" || arg == "--to-text") { loadAll(); return convertSnapshot(arg == "--to-binary") ? 0 : 1; }
+        else if ((arg == "--import-csv" || arg == "--export-csv") && i + 1 < argc) {
+            loadAll();
+            bool ok = arg == "--import-csv" ? importStudentsCsv(argv[i + 1]) : exportStudentsCsv(argv[i + 1]);
+            return ok ? 0 : 1;
+        }
+        else if (arg == "--batch") {
+            vector<string> files(argv + i + 1, argv + argc);
+            if (files.empty()) files.push_back("-");
+            return runBatch(files);
+        }
+        else if (arg == "--stress") {
+            unsigned threads = i + 1 < argc ? (unsigned)max(1, atoi(argv[i + 1])) : max(4u, hardwareThreads());
+            double seconds = i + 2 < argc ? max(0.1, atof(argv[i + 2])) : 3.0;
+            return runStress(threads, seconds);
+        }
+        else if (arg == "--serve" || arg == "--loadgen") {
+#ifdef SRMS_SERVER
+            int port = i + 1 < argc ? atoi(argv[i + 1]) : 8080;
+            if (arg == "--serve") return runServer(port, i + 2 < argc ? argv[i + 2] : "127.0.0.1");
+            unsigned conns = i + 2 < argc ? (unsigned)atoi(argv[i + 2]) : 16;
+            size_t total = i + 3 < argc ? (size_t)atoll(argv[i + 3]) : 100000;
+            unsigned depth = i + 4 < argc ? (unsigned)atoi(argv[i + 4]) : 8;
+            return runLoadGenerator(port, conns, total, depth);
+#else
+            cout << "❌ Server mode needs Linux (epoll).\n";
+            return 1;
+#endif
+        }
+        else if (arg == "--generate") {
+            vector<string> rest;
+            bool force = false;
+            for (int j = i + 1; j < argc; ++j) {
+                if (string(argv[j]) == "--force") force = true;
+                else rest.push_back(argv[j]);
+            }
+            if (rest.size() < 2 || !isDigits(rest[0]) || rest[0].size() > 9 || stoi(rest[0]) < 1) {
+                cout << "❌ Usage: srms --generate <rows> <dir> [subjects] [--force]\n";
+                return 1;
+            }
+            size_t rows = (size_t)stoi(rest[0]);
+            string dir = rest[1];
+            string existing = existingDataFile(dir);
+            if (!existing.empty() && !force) {
+                cout << "❌ " << dir << " already holds " << existing << "; pass --force to overwrite it.\n";
+                return 1;
+            }
+            if (rest.size() > 2) {
+                vector<string> names;
+                string err = parseSubjectList(rest[2], names);
+                if (!err.empty()) { cout << "❌ Invalid subject list: " << err << ".\n"; return 1; }
+                setSubjectSchema(names);
+            }
+            if (!generateRoster(rows, dir)) { cout << "❌ Could not write to " << dir << ".\n"; return 1; }
+            cout << "✔ Generated " << rows << " students in " << dir << ".\n";
+            return 0;
+        }
+        else if (arg == "--bench") {
+            vector<size_t> sizes;
+            for (int j = i + 1; j < argc; ++j) {
+                string size = argv[j];
+                if (!isDigits(size) || size.size() > 9 || stoi(size) < 1) {
+                    cout << "❌ Invalid benchmark size: " << size << " (expected a row count of at least 1).\n";
+                    return 1;
+                }
+                sizes.push_back((size_t)stoi(size));
+            }
+            return runBenchmarks(sizes);
+        }
+        else if (arg == "--bench-load") {
+            string file = i + 1 < argc ? argv[i + 1] : STUDENTS_FILE;
+            int runs = i + 2 < argc ? max(1, atoi(argv[i + 2])) : 3;
+            benchLoad(file, runs);
+            return 0;
+        }
+    }
     mainMenu();
     return 0;
 }